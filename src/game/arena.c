@@ -0,0 +1,22 @@
+#include "arena.h"
+#include <string.h>
+
+void initArena(Arena* arena, void* memory, size_t size) {
+    arena->base = (uint8_t*)memory;
+    arena->size = size;
+    arena->used = 0;
+
+    // Start aligned even if the host's block isn't
+    size_t misalignment = (uintptr_t)arena->base % ARENA_ALIGNMENT;
+    if (misalignment) arena->used = ARENA_ALIGNMENT - misalignment;
+}
+
+void* arenaPush(Arena* arena, size_t size) {
+    size_t aligned = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (arena->used > arena->size || aligned > arena->size - arena->used) return NULL;
+
+    void* memory = arena->base + arena->used;
+    arena->used += aligned;
+    memset(memory, 0, size);
+    return memory;
+}
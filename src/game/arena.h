@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump allocator over a block the host owns. Everything the game keeps
+// between frames is carved out of it once at startup, so it outlives the
+// library: after a hot reload the new code finds it all through GameState.
+// Nothing is freed individually; systems that recycle memory run their
+// own free lists inside what they pushed.
+
+#define ARENA_ALIGNMENT 16
+
+typedef struct Arena
+{
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} Arena;
+
+void initArena(Arena* arena, void* memory, size_t size);
+
+// Zeroed and aligned to ARENA_ALIGNMENT, or NULL when the arena is full
+void* arenaPush(Arena* arena, size_t size);
+
+#define ARENA_PUSH_STRUCT(arena, type) ((type*)arenaPush((arena), sizeof(type)))
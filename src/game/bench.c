@@ -0,0 +1,1283 @@
+#include "bench.h"
+#include "chunk.h"
+#include "liquid.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include "collision.h"
+#include "raycast.h"
+#include "tile_edit.h"
+#include "light.h"
+#include "pathfind.h"
+#include "entity.h"
+#include "decoration.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Built-in benchmarks and checks, run through gameBenchmark by a host
+// (see src/headless.c). Each one sets up its own scenario in the live
+// world and times only the part it measures.
+
+typedef int (*BenchFunc)(GameState* gameState, BenchReport* report);
+
+typedef struct BenchEntry
+{
+    const char* name;
+    BenchFunc run;
+} BenchEntry;
+
+static double nowSeconds() {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Loads every chunk in the range, generated and ready
+static void loadChunkRange(ChunkRange range) {
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++) createChunk(x, y);
+    }
+}
+
+// --- Liquid: drop a reservoir into an open cavern and let it drain ---
+
+#define LIQUID_BENCH_X 0
+#define LIQUID_BENCH_Y 10 // Chunk rows below the surface, inside the cave band
+#define LIQUID_BENCH_SIZE 24
+#define LIQUID_BENCH_FLOOD_ROWS 2
+#define LIQUID_BENCH_SHELF_SPACING 12 // Tile rows between staggered rock shelves
+#define LIQUID_BENCH_MAX_TICKS 5000
+
+// Overwrites the bench region with a fixed scenario so every seed measures
+// the same work: liquid in the top chunk rows (one chunk of lava), open
+// air below broken by staggered shelves, and a rock floor. The ring of
+// chunks around the region keeps its generated terrain.
+static int buildLiquidScenario() {
+    int regionHeight = LIQUID_BENCH_SIZE * CHUNK_SIZE;
+    int flooded = 0;
+
+    for (int cx = 0; cx < LIQUID_BENCH_SIZE; cx++) {
+        for (int cy = 0; cy < LIQUID_BENCH_SIZE; cy++) {
+            Chunk* chunk = getChunk(LIQUID_BENCH_X + cx, LIQUID_BENCH_Y + cy);
+            if (!chunk) continue;
+
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                for (int y = 0; y < CHUNK_SIZE; y++) {
+                    int regionX = cx * CHUNK_SIZE + x;
+                    int regionY = cy * CHUNK_SIZE + y;
+                    int shelf = regionY / LIQUID_BENCH_SHELF_SPACING;
+
+                    TileType tile = TILE_AIR;
+                    if (cy < LIQUID_BENCH_FLOOD_ROWS) {
+                        tile = (cx == 0 && cy == 0) ? TILE_LAVA : TILE_WATER;
+                        flooded++;
+                    } else if (regionY == regionHeight - 1) {
+                        tile = TILE_ROCK;
+                    } else if (regionY % LIQUID_BENCH_SHELF_SPACING == 0 &&
+                               (regionX / CHUNK_SIZE + shelf) % 3 != 0) {
+                        tile = TILE_ROCK;
+                    }
+                    chunk->tiles[x][y] = tile;
+                }
+            }
+            rebuildSolidMask(chunk);
+            markChunkChanged(chunk);
+            wakeChunkLiquids(chunk);
+        }
+    }
+    return flooded;
+}
+
+// The bench region plus the ring of generated chunks around it
+static const ChunkRange liquidBenchRange = {
+    LIQUID_BENCH_X - 1, LIQUID_BENCH_Y - 1,
+    LIQUID_BENCH_X + LIQUID_BENCH_SIZE, LIQUID_BENCH_Y + LIQUID_BENCH_SIZE
+};
+
+static int benchLiquid(GameState* gameState, BenchReport* report) {
+    loadChunkRange(liquidBenchRange);
+    int flooded = buildLiquidScenario();
+
+    LiquidStats before = getLiquidStats();
+    int ticks = 0;
+    int peakAwake = 0;
+
+    double start = nowSeconds();
+    while (!liquidsSettled() && ticks < LIQUID_BENCH_MAX_TICKS) {
+        updateLiquids();
+        ticks++;
+        int awake = getLiquidStats().awakeChunks;
+        if (awake > peakAwake) peakAwake = awake;
+    }
+    report->seconds = nowSeconds() - start;
+
+    LiquidStats after = getLiquidStats();
+    report->operations = after.cellsUpdated - before.cellsUpdated;
+    snprintf(report->unit, sizeof(report->unit), "cell updates");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d cells flooded, %d ticks (%s), %llu moves, %llu lava-water reactions, "
+             "peak %d awake chunks, %d threads",
+             flooded, ticks, liquidsSettled() ? "settled" : "still flowing",
+             (unsigned long long)(after.moves - before.moves),
+             (unsigned long long)(after.reactions - before.reactions), peakAwake, getJobThreadCount());
+    return 1;
+}
+
+// --- Liquid determinism: the same flood on one thread and on all of them ---
+
+#define DETERMINISM_TICKS 600 // Long enough for the reservoir to spill over several shelves
+
+typedef struct LiquidRun
+{
+    uint64_t tileHash;
+    uint64_t moves;
+} LiquidRun;
+
+static int countRangeChunks(ChunkRange range) {
+    return (range.endX - range.startX + 1) * (range.endY - range.startY + 1);
+}
+
+// FNV-1a over every tile in the range, chunk by chunk
+static uint64_t hashChunkRange(ChunkRange range) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++) {
+            Chunk* chunk = getChunk(x, y);
+            const uint8_t* bytes = chunk ? (const uint8_t*)chunk->tiles : NULL;
+            for (size_t i = 0; bytes && i < sizeof(chunk->tiles); i++) {
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+            }
+        }
+    }
+    return hash;
+}
+
+// Copies the range's tiles to or from saved, one chunk after another
+static void copyRangeTiles(ChunkRange range, uint8_t* saved, bool restore) {
+    size_t chunkBytes = sizeof(((Chunk*)0)->tiles);
+    int index = 0;
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++, index++) {
+            Chunk* chunk = getChunk(x, y);
+            if (!chunk) continue;
+            if (restore) {
+                memcpy(chunk->tiles, saved + index * chunkBytes, chunkBytes);
+                rebuildSolidMask(chunk);
+            } else {
+                memcpy(saved + index * chunkBytes, chunk->tiles, chunkBytes);
+            }
+        }
+    }
+}
+
+// Puts the range back to the saved tiles with nothing awake, then floods it
+static LiquidRun runLiquidScenario(ChunkRange range, uint8_t* saved, bool singleThreaded) {
+    copyRangeTiles(range, saved, true);
+    resetLiquids();
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++) {
+            Chunk* chunk = getChunk(x, y);
+            if (!chunk) continue;
+            memset(&chunk->liquid, 0, sizeof(chunk->liquid));
+            markChunkChanged(chunk);
+            wakeChunkLiquids(chunk);
+        }
+    }
+
+    setLiquidsSingleThreaded(singleThreaded);
+    for (int i = 0; i < DETERMINISM_TICKS && !liquidsSettled(); i++) updateLiquids();
+    setLiquidsSingleThreaded(false);
+
+    return (LiquidRun){hashChunkRange(range), getLiquidStats().moves};
+}
+
+static int checkLiquidDeterminism(GameState* gameState, BenchReport* report) {
+    ChunkRange range = liquidBenchRange;
+    loadChunkRange(range);
+    buildLiquidScenario();
+
+    uint8_t* saved = malloc((size_t)countRangeChunks(range) * sizeof(((Chunk*)0)->tiles));
+    if (!saved) {
+        snprintf(report->detail, sizeof(report->detail), "Out of memory");
+        return 0;
+    }
+    copyRangeTiles(range, saved, false);
+
+    double start = nowSeconds();
+    LiquidRun serial = runLiquidScenario(range, saved, true);
+    LiquidRun parallel = runLiquidScenario(range, saved, false);
+    LiquidRun again = runLiquidScenario(range, saved, false);
+    report->seconds = nowSeconds() - start;
+    free(saved);
+
+    report->passed = serial.tileHash == parallel.tileHash && serial.moves == parallel.moves &&
+                     parallel.tileHash == again.tileHash && parallel.moves == again.moves;
+    report->operations = 3;
+    snprintf(report->unit, sizeof(report->unit), "runs");
+    snprintf(report->detail, sizeof(report->detail),
+             "1 thread: %016llx (%llu moves), %d threads: %016llx (%llu moves), again: %016llx (%llu moves)",
+             (unsigned long long)serial.tileHash, (unsigned long long)serial.moves, getJobThreadCount(),
+             (unsigned long long)parallel.tileHash, (unsigned long long)parallel.moves,
+             (unsigned long long)again.tileHash, (unsigned long long)again.moves);
+    return report->passed;
+}
+
+// --- Occupancy: solid masks against the tiles, and rectangle queries ---
+
+#define OCCUPANCY_BENCH_RANGE ((ChunkRange){-16, 4, 15, 19}) // Across the seam, surface down into the caves
+#define OCCUPANCY_LIQUID_TICKS 300 // Lets lava and water react, which writes rock
+#define OCCUPANCY_QUERIES 200000
+#define OCCUPANCY_MAX_RECT 12 // Tiles per side, about a large body
+
+static uint32_t nextRandom(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// --- Jobs: many tiny batches, each with its own heap context ---
+
+#define JOBS_STRESS_BATCHES 200000
+#define JOBS_STRESS_MAX_COUNT 16
+#define JOBS_STRESS_RETIRED 64 // Contexts kept alive after their batch, so a late run is caught, not a crash
+
+typedef struct StressBatch
+{
+    atomic_int open; // Cleared once parallelFor has returned for it
+    atomic_int hits[JOBS_STRESS_MAX_COUNT];
+} StressBatch;
+
+static atomic_int staleRuns;
+
+static void runStressJob(void* context, int index) {
+    StressBatch* batch = context;
+    if (!atomic_load(&batch->open)) atomic_fetch_add(&staleRuns, 1);
+    atomic_fetch_add(&batch->hits[index], 1);
+}
+
+// Back-to-back batches are where a worker waking late could join a batch
+// that already returned and run its job for the next one's indices
+static int checkJobs(GameState* gameState, BenchReport* report) {
+    static StressBatch* retired[JOBS_STRESS_RETIRED];
+    uint32_t random = 0x3c6ef372u;
+    int wrongIndices = 0;
+    atomic_store(&staleRuns, 0);
+
+    double start = nowSeconds();
+    for (int b = 0; b < JOBS_STRESS_BATCHES; b++) {
+        StressBatch* batch = calloc(1, sizeof(StressBatch));
+        if (!batch) {
+            snprintf(report->detail, sizeof(report->detail), "Out of memory");
+            return 0;
+        }
+        int count = 2 + (int)(nextRandom(&random) % (JOBS_STRESS_MAX_COUNT - 1));
+        atomic_store(&batch->open, 1);
+        runJobs(count, runStressJob, batch, true);
+        atomic_store(&batch->open, 0);
+        for (int i = 0; i < count; i++) wrongIndices += atomic_load(&batch->hits[i]) != 1;
+
+        free(retired[b % JOBS_STRESS_RETIRED]);
+        retired[b % JOBS_STRESS_RETIRED] = batch;
+    }
+    report->seconds = nowSeconds() - start;
+
+    // Anything a straggler ran after its batch returned shows up here too
+    for (int i = 0; i < JOBS_STRESS_RETIRED; i++) {
+        free(retired[i]);
+        retired[i] = NULL;
+    }
+
+    int stale = atomic_load(&staleRuns);
+    report->passed = wrongIndices == 0 && stale == 0;
+    report->operations = JOBS_STRESS_BATCHES;
+    snprintf(report->unit, sizeof(report->unit), "batches");
+    snprintf(report->detail, sizeof(report->detail), "%d threads: %d indices not run exactly once, %d stale runs",
+             getJobThreadCount(), wrongIndices, stale);
+    return report->passed;
+}
+
+// Counts chunks whose mask disagrees with their tiles
+static int countStaleMasks(ChunkRange range) {
+    int stale = 0;
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++) {
+            Chunk* chunk = getChunk(x, y);
+            if (!chunk) continue;
+            bool matches = true;
+            for (int tx = 0; tx < CHUNK_SIZE; tx++) {
+                for (int ty = 0; ty < CHUNK_SIZE; ty++) {
+                    matches = matches && isCellSolid(chunk, tx, ty) == isSolidTile(chunk->tiles[tx][ty]);
+                }
+            }
+            stale += !matches;
+        }
+    }
+    return stale;
+}
+
+// The same question asked one tile at a time
+static bool isSolidInRectByTiles(int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    for (int x = minTileX; x <= maxTileX; x++) {
+        for (int y = minTileY; y <= maxTileY; y++) {
+            if (isSolidTile(getTileAt((x + 0.5f) * TILE_SIZE, (y + 0.5f) * TILE_SIZE))) return true;
+        }
+    }
+    return false;
+}
+
+static int benchOccupancy(GameState* gameState, BenchReport* report) {
+    ChunkRange range = OCCUPANCY_BENCH_RANGE;
+    loadChunkRange(range);
+    loadChunkRange(liquidBenchRange);
+    buildLiquidScenario();
+    for (int i = 0; i < OCCUPANCY_LIQUID_TICKS; i++) updateLiquids();
+
+    int stale = countStaleMasks(range) + countStaleMasks(liquidBenchRange);
+
+    // Rectangles anywhere in the range, in unwrapped coordinates
+    static int rects[OCCUPANCY_QUERIES][4];
+    uint32_t random = 0x9e3779b9u;
+    int spanX = (range.endX - range.startX + 1) * CHUNK_SIZE;
+    int spanY = (range.endY - range.startY + 1) * CHUNK_SIZE - OCCUPANCY_MAX_RECT;
+    for (int i = 0; i < OCCUPANCY_QUERIES; i++) {
+        rects[i][0] = range.startX * CHUNK_SIZE + (int)(nextRandom(&random) % spanX);
+        rects[i][1] = range.startY * CHUNK_SIZE + (int)(nextRandom(&random) % spanY);
+        rects[i][2] = rects[i][0] + (int)(nextRandom(&random) % OCCUPANCY_MAX_RECT);
+        rects[i][3] = rects[i][1] + (int)(nextRandom(&random) % OCCUPANCY_MAX_RECT);
+    }
+
+    static bool maskHits[OCCUPANCY_QUERIES];
+    double start = nowSeconds();
+    for (int i = 0; i < OCCUPANCY_QUERIES; i++) {
+        maskHits[i] = isSolidInRect(rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+    }
+    report->seconds = nowSeconds() - start;
+
+    int tileHits = 0;
+    int mismatches = 0;
+    start = nowSeconds();
+    for (int i = 0; i < OCCUPANCY_QUERIES; i++) {
+        bool hit = isSolidInRectByTiles(rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+        tileHits += hit;
+        mismatches += hit != maskHits[i];
+    }
+    double tileSeconds = nowSeconds() - start;
+
+    report->passed = stale == 0 && mismatches == 0;
+    report->operations = OCCUPANCY_QUERIES;
+    snprintf(report->unit, sizeof(report->unit), "rect queries");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d hit solid; per-tile getTileAt: %.0f queries/s; %d stale masks, %d mismatches",
+             tileHits, OCCUPANCY_QUERIES / tileSeconds, stale, mismatches);
+    return report->passed;
+}
+
+// --- Collision: many boxes bouncing around the caves ---
+
+#define COLLISION_BODIES 4096
+#define COLLISION_TICKS 120
+#define COLLISION_MAX_SPEED 400.0f // Pixels per second
+#define COLLISION_MIN_HALF_SIZE 2.0f
+#define COLLISION_MAX_HALF_SIZE 8.0f
+
+static float randomRange(uint32_t* state, float min, float max) {
+    return min + (max - min) * (nextRandom(state) & 0xffffff) / (float)0x1000000;
+}
+
+static int benchCollision(GameState* gameState, BenchReport* report) {
+    ChunkRange range = OCCUPANCY_BENCH_RANGE;
+    loadChunkRange(range);
+
+    static Vector2 positions[COLLISION_BODIES];
+    static Vector2 velocities[COLLISION_BODIES];
+    static Vector2 halfSizes[COLLISION_BODIES];
+
+    // Start every body somewhere open, across the seam and down into the caves
+    uint32_t random = 0x2545f491u;
+    float minX = range.startX * CHUNK_PIXEL_SIZE;
+    float maxX = (range.endX + 1) * CHUNK_PIXEL_SIZE;
+    float minY = range.startY * CHUNK_PIXEL_SIZE;
+    float maxY = (range.endY + 1) * CHUNK_PIXEL_SIZE;
+    for (int i = 0; i < COLLISION_BODIES; i++) {
+        float half = randomRange(&random, COLLISION_MIN_HALF_SIZE, COLLISION_MAX_HALF_SIZE);
+        halfSizes[i] = (Vector2){half, half};
+        do {
+            positions[i] = (Vector2){randomRange(&random, minX, maxX), randomRange(&random, minY, maxY)};
+        } while (boxOverlapsSolid(positions[i], halfSizes[i]));
+        velocities[i] = (Vector2){
+            randomRange(&random, -COLLISION_MAX_SPEED, COLLISION_MAX_SPEED),
+            randomRange(&random, -COLLISION_MAX_SPEED, COLLISION_MAX_SPEED),
+        };
+    }
+
+    int hits = 0;
+    double start = nowSeconds();
+    for (int tick = 0; tick < COLLISION_TICKS; tick++) {
+        for (int i = 0; i < COLLISION_BODIES; i++) {
+            Vector2 delta = {velocities[i].x * SIM_DT, velocities[i].y * SIM_DT};
+            SweepResult move = sweepBox(positions[i], halfSizes[i], delta);
+            positions[i] = move.center;
+            if (move.hitX) velocities[i].x = -velocities[i].x;
+            if (move.hitY) velocities[i].y = -velocities[i].y;
+            hits += move.hitX || move.hitY;
+        }
+    }
+    report->seconds = nowSeconds() - start;
+
+    // Nobody started inside rock, so nobody may end up there
+    int inside = 0;
+    for (int i = 0; i < COLLISION_BODIES; i++) inside += boxOverlapsSolid(positions[i], halfSizes[i]);
+
+    report->passed = inside == 0;
+    report->operations = (uint64_t)COLLISION_BODIES * COLLISION_TICKS;
+    snprintf(report->unit, sizeof(report->unit), "sweeps");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d bodies for %d ticks, %d sweeps stopped at a wall, %d bodies inside solid tiles",
+             COLLISION_BODIES, COLLISION_TICKS, hits, inside);
+    return report->passed;
+}
+
+// --- Raycast: batched hit-scan rays against a tile-by-tile walk ---
+
+#define RAYCAST_BATCH 1024
+#define RAYCAST_BATCHES 200
+#define RAYCAST_REFERENCE_BATCHES 10 // The reference is slow; check a sample
+#define RAYCAST_MAX_DISTANCE 1024.0f // Pixels, sixteen chunks
+#define RAYCAST_CORNER_TOLERANCE 0.01f // Pixels
+
+// The plain DDA: one isSolidAt per tile, nothing skipped
+static bool castTileRayByTiles(TileRay ray, TileRayHit* hit) {
+    memset(hit, 0, sizeof(*hit));
+    float length = sqrtf(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y);
+    float dirX = ray.direction.x / length;
+    float dirY = ray.direction.y / length;
+    float originX = ray.origin.x / TILE_SIZE;
+    float originY = ray.origin.y / TILE_SIZE;
+    int tileX = (int)floorf(originX);
+    int tileY = (int)floorf(originY);
+    int stepX = (dirX > 0) ? 1 : -1;
+    int stepY = (dirY > 0) ? 1 : -1;
+    float tMaxX = (dirX != 0.0f) ? (tileX + (stepX > 0) - originX) / dirX : INFINITY;
+    float tMaxY = (dirY != 0.0f) ? (tileY + (stepY > 0) - originY) / dirY : INFINITY;
+    float t = 0.0f;
+
+    while (t <= ray.maxDistance / TILE_SIZE) {
+        if (isSolidAt(tileX, tileY)) {
+            hit->hit = true;
+            hit->tileX = tileX;
+            hit->tileY = tileY;
+            hit->distance = t * TILE_SIZE;
+            return true;
+        }
+        if (tMaxX < tMaxY) {
+            t = tMaxX;
+            tMaxX += fabsf(1.0f / dirX);
+            tileX += stepX;
+        } else {
+            t = tMaxY;
+            tMaxY += fabsf(1.0f / dirY);
+            tileY += stepY;
+        }
+    }
+    return false;
+}
+
+static int benchRaycast(GameState* gameState, BenchReport* report) {
+    ChunkRange range = OCCUPANCY_BENCH_RANGE;
+    loadChunkRange(range);
+
+    // Rays from open tiles anywhere in the range, sky and caves, every direction
+    static TileRay rays[RAYCAST_BATCHES][RAYCAST_BATCH];
+    static TileRayHit hits[RAYCAST_BATCHES][RAYCAST_BATCH];
+    uint32_t random = 0x6c8e9cf5u;
+    for (int b = 0; b < RAYCAST_BATCHES; b++) {
+        for (int i = 0; i < RAYCAST_BATCH; i++) {
+            Vector2 origin;
+            do {
+                origin = (Vector2){
+                    randomRange(&random, range.startX * CHUNK_PIXEL_SIZE, (range.endX + 1) * CHUNK_PIXEL_SIZE),
+                    randomRange(&random, range.startY * CHUNK_PIXEL_SIZE, (range.endY + 1) * CHUNK_PIXEL_SIZE),
+                };
+            } while (isSolidAt((int)floorf(origin.x / TILE_SIZE), (int)floorf(origin.y / TILE_SIZE)));
+
+            float angle = randomRange(&random, 0.0f, 2.0f * PI);
+            rays[b][i] = (TileRay){origin, {cosf(angle), sinf(angle)}, RAYCAST_MAX_DISTANCE};
+        }
+    }
+
+    double start = nowSeconds();
+    for (int b = 0; b < RAYCAST_BATCHES; b++) castTileRays(rays[b], hits[b], RAYCAST_BATCH);
+    report->seconds = nowSeconds() - start;
+
+    int hitCount = 0;
+    for (int b = 0; b < RAYCAST_BATCHES; b++) {
+        for (int i = 0; i < RAYCAST_BATCH; i++) hitCount += hits[b][i].hit;
+    }
+
+    int mismatches = 0;
+    start = nowSeconds();
+    for (int b = 0; b < RAYCAST_REFERENCE_BATCHES; b++) {
+        for (int i = 0; i < RAYCAST_BATCH; i++) {
+            TileRayHit expected;
+            castTileRayByTiles(rays[b][i], &expected);
+            const TileRayHit* actual = &hits[b][i];
+            // A ray through a tile corner may fairly report either tile
+            bool sameTile = expected.tileX == actual->tileX && expected.tileY == actual->tileY;
+            bool sameDistance = fabsf(expected.distance - actual->distance) < RAYCAST_CORNER_TOLERANCE;
+            mismatches += expected.hit != actual->hit || (expected.hit && !sameTile && !sameDistance);
+        }
+    }
+    double referenceSeconds = nowSeconds() - start;
+
+    report->passed = mismatches == 0;
+    report->operations = (uint64_t)RAYCAST_BATCHES * RAYCAST_BATCH;
+    snprintf(report->unit, sizeof(report->unit), "rays");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d hit, up to %.0f px; tile-by-tile reference: %.0f rays/s, %d mismatches in %d rays",
+             hitCount, RAYCAST_MAX_DISTANCE, RAYCAST_REFERENCE_BATCHES * RAYCAST_BATCH / referenceSeconds,
+             mismatches, RAYCAST_REFERENCE_BATCHES * RAYCAST_BATCH);
+    return report->passed;
+}
+
+// --- Edit: blasts of random size and tile all over a region ---
+
+#define EDIT_BENCH_RANGE ((ChunkRange){-8, 4, 7, 19}) // Across the seam, surface down into the caves
+#define EDIT_BLASTS 20000
+#define EDIT_MAX_RADIUS 8 // Reaches at most three chunks a side, border included
+#define EDIT_CHECK_INTERVAL 16 // Every this many blasts is checked tile by tile
+
+typedef struct EditSnapshot
+{
+    Chunk* chunk;
+    uint32_t version;
+    TileType tiles[CHUNK_SIZE][CHUNK_SIZE];
+} EditSnapshot;
+
+// The chunks a blast at (tileX, tileY) can reach
+static int snapshotBlastArea(int tileX, int tileY, EditSnapshot* snapshots) {
+    int count = 0;
+    int startX = (int)floorf((tileX - EDIT_MAX_RADIUS - 1) / (float)CHUNK_SIZE);
+    int startY = (int)floorf((tileY - EDIT_MAX_RADIUS - 1) / (float)CHUNK_SIZE);
+    for (int x = startX; x < startX + 3; x++) {
+        for (int y = startY; y < startY + 3; y++) {
+            Chunk* chunk = getChunk(x, y);
+            if (!chunk) continue;
+            snapshots[count].chunk = chunk;
+            snapshots[count].version = chunk->version;
+            memcpy(snapshots[count].tiles, chunk->tiles, sizeof(chunk->tiles));
+            count++;
+        }
+    }
+    return count;
+}
+
+// A changed chunk went up exactly one version and changed only inside its
+// dirty rectangle; an untouched one kept its version
+static bool checkBlastArea(const EditSnapshot* snapshots, int count) {
+    for (int i = 0; i < count; i++) {
+        const Chunk* chunk = snapshots[i].chunk;
+        bool changed = memcmp(snapshots[i].tiles, chunk->tiles, sizeof(chunk->tiles)) != 0;
+        if (chunk->version != snapshots[i].version + (changed ? 1 : 0)) return false;
+        if (!changed) continue;
+
+        int minX, minY, maxX, maxY;
+        if (!getChunkChangesSince(chunk, snapshots[i].version, &minX, &minY, &maxX, &maxY)) return false;
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                bool inside = x >= minX && x <= maxX && y >= minY && y <= maxY;
+                if (!inside && snapshots[i].tiles[x][y] != chunk->tiles[x][y]) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Every loaded tile within the radius holds the blast's tile
+static bool checkBlastTiles(int centerX, int centerY, int radius, TileType tile) {
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            if (dx * dx + dy * dy > radius * radius) continue;
+            float worldX = (centerX + dx + 0.5f) * TILE_SIZE;
+            float worldY = (centerY + dy + 0.5f) * TILE_SIZE;
+            Vector2 chunkCoord = worldToChunkCoord((Vector2){worldX, worldY});
+            if (!getChunk((int)chunkCoord.x, (int)chunkCoord.y)) continue;
+            if (getTileAt(worldX, worldY) != tile) return false;
+        }
+    }
+    return true;
+}
+
+// The same blast one setTile per tile, as a baseline
+static int fillCircleByTiles(int centerX, int centerY, int radius, TileType tile) {
+    int changed = 0;
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            if (dx * dx + dy * dy <= radius * radius) changed += setTile(centerX + dx, centerY + dy, tile);
+        }
+    }
+    return changed;
+}
+
+// A lap that doesn't start on a chunk boundary, and one wider than the
+// world, each write every tile of their row exactly once
+#define EDIT_LAP_CHUNK_Y 10
+
+static int checkLapEdits() {
+    for (int x = 0; x < WORLD_WIDTH_CHUNKS; x++) createChunk(x, EDIT_LAP_CHUNK_Y);
+
+    static const int laps[][2] = {{5, 5 + WORLD_WIDTH_TILES - 1}, {-7, 2 * WORLD_WIDTH_TILES}};
+    int failures = 0;
+    for (int i = 0; i < 2; i++) {
+        float worldY = (EDIT_LAP_CHUNK_Y * CHUNK_SIZE + 3 + i + 0.5f) * TILE_SIZE;
+        int expected = 0;
+        for (int x = 0; x < WORLD_WIDTH_TILES; x++) expected += getTileAt((x + 0.5f) * TILE_SIZE, worldY) != TILE_ROCK;
+
+        advanceChunkEditEpoch();
+        int tileY = (int)(worldY / TILE_SIZE);
+        int changed = fillRect(laps[i][0], tileY, laps[i][1], tileY, TILE_ROCK);
+        int missed = 0;
+        for (int x = 0; x < WORLD_WIDTH_TILES; x++) missed += getTileAt((x + 0.5f) * TILE_SIZE, worldY) != TILE_ROCK;
+        failures += changed != expected || missed != 0;
+    }
+    return failures;
+}
+
+static int benchEdit(GameState* gameState, BenchReport* report) {
+    static const TileType blastTiles[] = {TILE_AIR, TILE_AIR, TILE_ROCK, TILE_WATER};
+    ChunkRange range = EDIT_BENCH_RANGE;
+    loadChunkRange(range);
+    resetLiquids();
+
+    static int blasts[EDIT_BLASTS][4];
+    uint32_t random = 0x2545f491u;
+    int margin = EDIT_MAX_RADIUS + 1;
+    int spanX = (range.endX - range.startX + 1) * CHUNK_SIZE - 2 * margin;
+    int spanY = (range.endY - range.startY + 1) * CHUNK_SIZE - 2 * margin;
+    for (int i = 0; i < EDIT_BLASTS; i++) {
+        blasts[i][0] = range.startX * CHUNK_SIZE + margin + (int)(nextRandom(&random) % spanX);
+        blasts[i][1] = range.startY * CHUNK_SIZE + margin + (int)(nextRandom(&random) % spanY);
+        blasts[i][2] = 1 + (int)(nextRandom(&random) % EDIT_MAX_RADIUS);
+        blasts[i][3] = blastTiles[nextRandom(&random) % 4];
+    }
+
+    uint64_t changed = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < EDIT_BLASTS; i++) {
+        advanceChunkEditEpoch();
+        changed += fillCircle(blasts[i][0], blasts[i][1], blasts[i][2], (TileType)blasts[i][3]);
+    }
+    report->seconds = nowSeconds() - start;
+
+    // Again, checking each sampled blast against what it left behind
+    static EditSnapshot snapshots[9];
+    int failures = 0;
+    for (int i = 0; i < EDIT_BLASTS; i += EDIT_CHECK_INTERVAL) {
+        int count = snapshotBlastArea(blasts[i][0], blasts[i][1], snapshots);
+        advanceChunkEditEpoch();
+        fillCircle(blasts[i][0], blasts[i][1], blasts[i][2], (TileType)blasts[i][3]);
+        bool ok = checkBlastArea(snapshots, count) &&
+                  checkBlastTiles(blasts[i][0], blasts[i][1], blasts[i][2], (TileType)blasts[i][3]);
+        failures += !ok;
+    }
+
+    int stale = countStaleMasks(range);
+    int badLaps = checkLapEdits();
+
+    start = nowSeconds();
+    for (int i = 0; i < EDIT_BLASTS; i++) {
+        advanceChunkEditEpoch();
+        fillCircleByTiles(blasts[i][0], blasts[i][1], blasts[i][2], (TileType)blasts[i][3]);
+    }
+    double tileSeconds = nowSeconds() - start;
+
+    // The blasts poured water about; let the liquid pass pick it up
+    updateLiquids();
+    LiquidStats liquids = getLiquidStats();
+
+    report->passed = failures == 0 && stale == 0 && badLaps == 0 && liquids.awakeChunks > 0;
+    report->operations = EDIT_BLASTS;
+    snprintf(report->unit, sizeof(report->unit), "blasts");
+    snprintf(report->detail, sizeof(report->detail),
+             "%llu tiles changed; per-tile setTile: %.0f blasts/s; %d bad blasts, %d bad laps, %d stale masks, "
+             "%d awake chunks",
+             (unsigned long long)changed, EDIT_BLASTS / tileSeconds, failures, badLaps, stale, liquids.awakeChunks);
+    return report->passed;
+}
+
+// --- Light: small edits relit incrementally, against relighting chunks ---
+
+#define LIGHT_BENCH_RANGE ((ChunkRange){-8, 4, 7, 19}) // Open sky down into the caves
+#define LIGHT_EDITS 2000
+#define LIGHT_MAX_EDIT_RADIUS 3
+#define LIGHT_LIQUID_TICKS 120 // Lets the lava the edits dropped flow
+
+static Chunk* getLitBenchChunk(int chunkX, int chunkY) {
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    return (chunk && chunk->generated && chunk->light.lit) ? chunk : NULL;
+}
+
+// The light rules restated per cell, from scratch
+static int expectedLight(Chunk* chunk, int x, int y, LightChannel channel) {
+    static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    TileType tile = chunk->tiles[x][y];
+    bool solid = isSolidTile(tile);
+    int expected = (channel == LIGHT_BLOCK && tile == TILE_LAVA) ? LAVA_LIGHT : 0;
+    if (channel == LIGHT_SKY && y == 0 && chunk->light.openSky && !getLitBenchChunk(chunk->x, chunk->y - 1)) {
+        expected = solid ? LIGHT_MAX - LIGHT_SOLID_FALLOFF : LIGHT_MAX;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        int nx = x + offsets[i][0], ny = y + offsets[i][1];
+        Chunk* neighbor = chunk;
+        if (nx < 0 || nx >= CHUNK_SIZE || ny < 0 || ny >= CHUNK_SIZE) {
+            neighbor = getLitBenchChunk(chunk->x + offsets[i][0], chunk->y + offsets[i][1]);
+            if (!neighbor) continue;
+            nx &= CHUNK_SIZE - 1;
+            ny &= CHUNK_SIZE - 1;
+        }
+
+        int level = getLightLevel(neighbor, nx, ny, channel);
+        int spread = level - (solid ? LIGHT_SOLID_FALLOFF : 1);
+        bool fromAbove = offsets[i][1] == -1;
+        if (channel == LIGHT_SKY && fromAbove && !solid && level == LIGHT_MAX) spread = LIGHT_MAX;
+        if (spread > expected) expected = spread;
+    }
+    return expected;
+}
+
+// Cells whose level isn't what their surroundings give them. Light is the
+// only fixpoint of these rules, so zero here means fully correct.
+static int countWrongLight(ChunkRange range) {
+    int wrong = 0;
+    for (int cx = range.startX; cx <= range.endX; cx++) {
+        for (int cy = range.startY; cy <= range.endY; cy++) {
+            Chunk* chunk = getLitBenchChunk(cx, cy);
+            if (!chunk) continue;
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                for (int y = 0; y < CHUNK_SIZE; y++) {
+                    wrong += getLightLevel(chunk, x, y, LIGHT_BLOCK) != expectedLight(chunk, x, y, LIGHT_BLOCK);
+                    wrong += getLightLevel(chunk, x, y, LIGHT_SKY) != expectedLight(chunk, x, y, LIGHT_SKY);
+                }
+            }
+        }
+    }
+    return wrong;
+}
+
+static int benchLight(GameState* gameState, BenchReport* report) {
+    static const TileType editTiles[] = {TILE_AIR, TILE_AIR, TILE_ROCK, TILE_LAVA};
+    ChunkRange range = LIGHT_BENCH_RANGE;
+    loadChunkRange(range);
+    resetLiquids();
+    int wrongAfterLoad = countWrongLight(range);
+
+    static int edits[LIGHT_EDITS][4];
+    uint32_t random = 0x6c8e9cf5u;
+    int spanX = (range.endX - range.startX + 1) * CHUNK_SIZE - 2 * LIGHT_MAX_EDIT_RADIUS;
+    int spanY = (range.endY - range.startY + 1) * CHUNK_SIZE - 2 * LIGHT_MAX_EDIT_RADIUS;
+    for (int i = 0; i < LIGHT_EDITS; i++) {
+        edits[i][0] = range.startX * CHUNK_SIZE + LIGHT_MAX_EDIT_RADIUS + (int)(nextRandom(&random) % spanX);
+        edits[i][1] = range.startY * CHUNK_SIZE + LIGHT_MAX_EDIT_RADIUS + (int)(nextRandom(&random) % spanY);
+        edits[i][2] = (int)(nextRandom(&random) % (LIGHT_MAX_EDIT_RADIUS + 1));
+        edits[i][3] = editTiles[nextRandom(&random) % 4];
+    }
+
+    LightStats before = getLightStats();
+    double start = nowSeconds();
+    for (int i = 0; i < LIGHT_EDITS; i++) {
+        advanceChunkEditEpoch();
+        fillCircle(edits[i][0], edits[i][1], edits[i][2], (TileType)edits[i][3]);
+    }
+    report->seconds = nowSeconds() - start;
+    LightStats after = getLightStats();
+    int wrongAfterEdits = countWrongLight(range);
+
+    for (int i = 0; i < LIGHT_LIQUID_TICKS; i++) {
+        updateLiquids();
+        updateLiquidLight();
+    }
+    int wrongAfterLiquids = countWrongLight(range);
+
+    // The naive alternative: relight every chunk in the range
+    int chunkCount = 0;
+    start = nowSeconds();
+    for (int cx = range.startX; cx <= range.endX; cx++) {
+        for (int cy = range.startY; cy <= range.endY; cy++) {
+            Chunk* chunk = getLitBenchChunk(cx, cy);
+            if (!chunk) continue;
+            lightChunk(chunk);
+            chunkCount++;
+        }
+    }
+    double relightSeconds = nowSeconds() - start;
+    int wrongAfterRelight = countWrongLight(range);
+    uint64_t overflows = getLightStats().overflows;
+
+    int wrong = wrongAfterLoad + wrongAfterEdits + wrongAfterLiquids + wrongAfterRelight;
+    report->passed = wrong == 0 && overflows == 0;
+    report->operations = LIGHT_EDITS;
+    snprintf(report->unit, sizeof(report->unit), "edits");
+    snprintf(report->detail, sizeof(report->detail),
+             "%.0f cells visited per edit; relighting all %d chunks: %.1f ms; "
+             "wrong cells after load/edits/liquids/relight: %d/%d/%d/%d; %llu overflows",
+             (double)(after.cellsVisited - before.cellsVisited) / LIGHT_EDITS, chunkCount, relightSeconds * 1000.0,
+             wrongAfterLoad, wrongAfterEdits, wrongAfterLiquids, wrongAfterRelight, (unsigned long long)overflows);
+    return report->passed;
+}
+
+// --- Path: long queries across caves, against a tile-level search ---
+
+#define PATH_BENCH_RANGE ((ChunkRange){-20, 6, 19, 13}) // The surface down into the caves, clear of the spawn chunks
+#define PATH_QUERIES 200
+#define PATH_WARM_ROUNDS 5
+#define PATH_EDITS 100
+#define PATH_MAX_EDIT_RADIUS 4
+#define PATH_RANGE_WIDTH (40 * CHUNK_SIZE)
+#define PATH_RANGE_HEIGHT (8 * CHUNK_SIZE)
+
+// Steps from one tile to every tile of the range by breadth-first search,
+// -1 where unreachable. Paths stay inside the range, as nothing loaded
+// around it connects.
+static void floodRangeByTiles(ChunkRange range, int fromX, int fromY, int* distance) {
+    static int queue[PATH_RANGE_WIDTH * PATH_RANGE_HEIGHT];
+    static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    int originX = range.startX * CHUNK_SIZE, originY = range.startY * CHUNK_SIZE;
+    for (int i = 0; i < PATH_RANGE_WIDTH * PATH_RANGE_HEIGHT; i++) distance[i] = -1;
+
+    int head = 0, tail = 0;
+    int from = (fromY - originY) * PATH_RANGE_WIDTH + (fromX - originX);
+    distance[from] = 0;
+    queue[tail++] = from;
+    while (head < tail) {
+        int cell = queue[head++];
+        int x = cell % PATH_RANGE_WIDTH, y = cell / PATH_RANGE_WIDTH;
+        for (int i = 0; i < 4; i++) {
+            int nx = x + offsets[i][0], ny = y + offsets[i][1];
+            if (nx < 0 || nx >= PATH_RANGE_WIDTH || ny < 0 || ny >= PATH_RANGE_HEIGHT) continue;
+            int next = ny * PATH_RANGE_WIDTH + nx;
+            if (distance[next] >= 0 || isSolidAt(originX + nx, originY + ny)) continue;
+            distance[next] = distance[cell] + 1;
+            queue[tail++] = next;
+        }
+    }
+}
+
+// A path has to start and end where asked and take single steps through
+// open tiles
+static bool checkPath(const NavPath* path, int startX, int startY, int goalX, int goalY) {
+    if (path->truncated || path->length != path->cost + 1) return false;
+    const NavPoint* points = path->points;
+    if (points[0].x != startX || points[0].y != startY) return false;
+    if (points[path->length - 1].x != goalX || points[path->length - 1].y != goalY) return false;
+    for (int i = 0; i < path->length; i++) {
+        if (isSolidAt(points[i].x, points[i].y)) return false;
+        if (i > 0 && abs(points[i].x - points[i - 1].x) + abs(points[i].y - points[i - 1].y) != 1) return false;
+    }
+    return true;
+}
+
+typedef struct PathCheck
+{
+    int bad;           // Invalid paths, or found when there is none and vice versa
+    int found;
+    long long cost;    // Summed over found paths
+    long long optimal; // The tile-level shortest, same paths
+} PathCheck;
+
+static PathCheck checkPathQueries(ChunkRange range, int queries[][4], int count, NavPath* path) {
+    static int distance[PATH_RANGE_WIDTH * PATH_RANGE_HEIGHT];
+    int originX = range.startX * CHUNK_SIZE, originY = range.startY * CHUNK_SIZE;
+    PathCheck check = {0};
+    for (int i = 0; i < count; i++) {
+        int* q = queries[i];
+        bool found = findPath(q[0], q[1], q[2], q[3], path);
+        int optimal = -1;
+        if (!isSolidAt(q[0], q[1])) {
+            floodRangeByTiles(range, q[0], q[1], distance);
+            optimal = distance[(q[3] - originY) * PATH_RANGE_WIDTH + (q[2] - originX)];
+        }
+
+        if (found != (optimal >= 0) || (found && (!checkPath(path, q[0], q[1], q[2], q[3]) || path->cost < optimal))) {
+            check.bad++;
+        } else if (found) {
+            check.found++;
+            check.cost += path->cost;
+            check.optimal += optimal;
+        }
+    }
+    return check;
+}
+
+// Picks open start tiles in the left quarter of the range and goals
+// reachable from them in the right quarter, at least 20 chunks apart
+static void pickPathQueries(ChunkRange range, int queries[][4], int count) {
+    static int distance[PATH_RANGE_WIDTH * PATH_RANGE_HEIGHT];
+    uint32_t random = 0x2545f491u;
+    int originX = range.startX * CHUNK_SIZE, originY = range.startY * CHUNK_SIZE;
+    for (int i = 0; i < count;) {
+        int startX = originX + (int)(nextRandom(&random) % (PATH_RANGE_WIDTH / 4));
+        int startY = originY + (int)(nextRandom(&random) % PATH_RANGE_HEIGHT);
+        if (isSolidAt(startX, startY)) continue;
+        floodRangeByTiles(range, startX, startY, distance);
+
+        for (int attempt = 0; attempt < 64; attempt++) {
+            int goalX = originX + PATH_RANGE_WIDTH * 3 / 4 + (int)(nextRandom(&random) % (PATH_RANGE_WIDTH / 4));
+            int goalY = originY + (int)(nextRandom(&random) % PATH_RANGE_HEIGHT);
+            if (distance[(goalY - originY) * PATH_RANGE_WIDTH + (goalX - originX)] < 0) continue;
+            queries[i][0] = startX;
+            queries[i][1] = startY;
+            queries[i][2] = goalX;
+            queries[i][3] = goalY;
+            i++;
+            break;
+        }
+    }
+}
+
+static int benchPath(GameState* gameState, BenchReport* report) {
+    static int queries[PATH_QUERIES][4];
+    static NavPath path;
+    ChunkRange range = PATH_BENCH_RANGE;
+    loadChunkRange(range);
+    pickPathQueries(range, queries, PATH_QUERIES);
+
+    // Cold: every chunk's graph is built on first touch
+    PathStats before = getPathStats();
+    double start = nowSeconds();
+    for (int i = 0; i < PATH_QUERIES; i++) findPath(queries[i][0], queries[i][1], queries[i][2], queries[i][3], &path);
+    double coldSeconds = nowSeconds() - start;
+    uint64_t coldRebuilt = getPathStats().chunksRebuilt - before.chunksRebuilt;
+
+    before = getPathStats();
+    start = nowSeconds();
+    for (int round = 0; round < PATH_WARM_ROUNDS; round++) {
+        for (int i = 0; i < PATH_QUERIES; i++) findPath(queries[i][0], queries[i][1], queries[i][2], queries[i][3], &path);
+    }
+    report->seconds = nowSeconds() - start;
+    PathStats after = getPathStats();
+    PathCheck beforeEdits = checkPathQueries(range, queries, PATH_QUERIES, &path);
+
+    // Dig and fill across the range; only the chunks whose solidity changed
+    // (or whose neighbours' did, along the shared border) get rebuilt
+    uint32_t random = 0x1b873593u;
+    int spanX = PATH_RANGE_WIDTH - 2 * PATH_MAX_EDIT_RADIUS;
+    int spanY = PATH_RANGE_HEIGHT - 2 * PATH_MAX_EDIT_RADIUS;
+    for (int i = 0; i < PATH_EDITS; i++) {
+        advanceChunkEditEpoch();
+        fillCircle(range.startX * CHUNK_SIZE + PATH_MAX_EDIT_RADIUS + (int)(nextRandom(&random) % spanX),
+                   range.startY * CHUNK_SIZE + PATH_MAX_EDIT_RADIUS + (int)(nextRandom(&random) % spanY),
+                   1 + (int)(nextRandom(&random) % PATH_MAX_EDIT_RADIUS), (nextRandom(&random) & 1) ? TILE_AIR : TILE_ROCK);
+    }
+    uint64_t rebuiltBefore = getPathStats().chunksRebuilt;
+    PathCheck afterEdits = checkPathQueries(range, queries, PATH_QUERIES, &path);
+    uint64_t editRebuilt = getPathStats().chunksRebuilt - rebuiltBefore;
+
+    long long cost = beforeEdits.cost + afterEdits.cost;
+    long long optimal = beforeEdits.optimal + afterEdits.optimal;
+    report->passed = beforeEdits.bad == 0 && afterEdits.bad == 0 && after.searchOverflows == 0;
+    report->operations = (uint64_t)PATH_QUERIES * PATH_WARM_ROUNDS;
+    snprintf(report->unit, sizeof(report->unit), "queries");
+    snprintf(report->detail, sizeof(report->detail),
+             "%.1f us per query warm, %.1f cold (%llu chunk graphs built); %.0f nodes expanded per query; "
+             "%llu graphs rebuilt after %d edits; path cost %.3fx shortest; bad paths before/after edits: %d/%d "
+             "(%d/%d found); %llu overflows",
+             report->seconds * 1e6 / report->operations, coldSeconds * 1e6 / PATH_QUERIES,
+             (unsigned long long)coldRebuilt,
+             (double)(after.nodesExpanded - before.nodesExpanded) / report->operations,
+             (unsigned long long)editRebuilt, PATH_EDITS, optimal ? (double)cost / optimal : 1.0, beforeEdits.bad,
+             afterEdits.bad, beforeEdits.found, afterEdits.found, (unsigned long long)after.searchOverflows);
+    return report->passed;
+}
+
+// --- Entities: a crowd moving through the caves, broadphase and parking ---
+
+#define ENTITY_BENCH_RANGE ((ChunkRange){-10, 4, 9, 11}) // The surface down into the caves
+#define ENTITY_BENCH_COUNT 10000
+#define ENTITY_BENCH_TICKS 300
+#define ENTITY_BENCH_QUERIES 200
+#define ENTITY_BENCH_MAX_SPEED 60.0f // Pixels per second
+#define ENTITY_BENCH_MAX_PAIRS (1 << 18)
+
+static bool isEntityChunkResident(Vector2 position) {
+    Vector2 coord = worldToChunkCoord(position);
+    Chunk* chunk = getChunk((int)coord.x, (int)coord.y);
+    return chunk && chunk->generated;
+}
+
+// Every entity is in the cell for its position, listed once, active
+// exactly when its chunk is loaded, and found by its id
+static int countBadEntities(const EntityState* store) {
+    int bad = 0, listed = 0;
+    for (int c = 0; c < ENTITY_CELL_CAPACITY; c++) {
+        const EntityCell* cell = &store->cellTable[c];
+        if (cell->first < 0) continue;
+        int count = 0;
+        for (int i = cell->first; i >= 0 && count <= store->count; i = store->cellNext[i]) count++;
+        bad += count != cell->count;
+        listed += count;
+    }
+    bad += listed != store->count;
+
+    for (int i = 0; i < store->count; i++) {
+        const EntityCell* cell = &store->cellTable[store->cells[i]];
+        Vector2 coord = worldToChunkCoord(store->positions[i]);
+        bool parked = i >= store->activeCount;
+        bad += cell->first < 0 || cell->chunkX != (int)coord.x || cell->chunkY != (int)coord.y;
+        bad += parked != cell->parked || parked == isEntityChunkResident(store->positions[i]);
+        bad += getEntityIndex(store->ids[i]) != i;
+    }
+    return bad;
+}
+
+static bool entitiesOverlap(const EntityState* store, int a, int b) {
+    float dx = fabsf(store->positions[a].x - store->positions[b].x);
+    if (dx > WORLD_WIDTH_PIXELS / 2) dx = WORLD_WIDTH_PIXELS - dx;
+    float dy = fabsf(store->positions[a].y - store->positions[b].y);
+    return dx < store->halfSizes[a].x + store->halfSizes[b].x && dy < store->halfSizes[a].y + store->halfSizes[b].y;
+}
+
+static int compareEntityPairs(const void* left, const void* right) {
+    const EntityPair* a = left;
+    const EntityPair* b = right;
+    return (a->a != b->a) ? a->a - b->a : a->b - b->b;
+}
+
+// The broadphase against testing every pair: each pair it reports must
+// be active, overlap and come up once, and there must be as many
+static int countBadPairs(const EntityState* store, EntityPair* pairs, int* pairCount) {
+    int count = findEntityPairs(pairs, ENTITY_BENCH_MAX_PAIRS);
+    *pairCount = count;
+    if (count > ENTITY_BENCH_MAX_PAIRS) return count;
+
+    int bad = 0;
+    for (int i = 0; i < count; i++) {
+        int a = pairs[i].a, b = pairs[i].b;
+        if (a == b || a >= store->activeCount || b >= store->activeCount || !entitiesOverlap(store, a, b)) bad++;
+        if (a > b) pairs[i] = (EntityPair){b, a};
+    }
+    qsort(pairs, (size_t)count, sizeof(pairs[0]), compareEntityPairs);
+    for (int i = 1; i < count; i++) bad += compareEntityPairs(&pairs[i - 1], &pairs[i]) == 0;
+
+    int expected = 0;
+    for (int a = 0; a < store->activeCount; a++) {
+        for (int b = a + 1; b < store->activeCount; b++) expected += entitiesOverlap(store, a, b);
+    }
+    return bad + (expected != count);
+}
+
+static Vector2 randomEntityVelocity(uint32_t* random) {
+    return (Vector2){randomRange(random, -ENTITY_BENCH_MAX_SPEED, ENTITY_BENCH_MAX_SPEED),
+                     randomRange(random, -ENTITY_BENCH_MAX_SPEED, ENTITY_BENCH_MAX_SPEED)};
+}
+
+// Spawns entities of random types and sizes in open space in the range
+static void spawnBenchEntities(uint32_t* random, ChunkRange range, int count) {
+    float minX = range.startX * CHUNK_PIXEL_SIZE, spanX = (range.endX - range.startX + 1) * CHUNK_PIXEL_SIZE;
+    float minY = range.startY * CHUNK_PIXEL_SIZE, spanY = (range.endY - range.startY + 1) * CHUNK_PIXEL_SIZE;
+    for (int spawned = 0; spawned < count;) {
+        Vector2 position = {randomRange(random, minX, minX + spanX), randomRange(random, minY, minY + spanY)};
+        Vector2 half = {randomRange(random, 1.0f, 6.0f), randomRange(random, 1.0f, 6.0f)};
+        if (boxOverlapsSolid(position, half)) continue;
+        spawnEntity((EntityType)(nextRandom(random) % ENTITY_TYPE_COUNT), position, randomEntityVelocity(random), half);
+        spawned++;
+    }
+}
+
+static int benchEntities(GameState* gameState, BenchReport* report) {
+    static EntityPair pairs[ENTITY_BENCH_MAX_PAIRS];
+    static int found[ENTITY_CAPACITY];
+    ChunkRange range = ENTITY_BENCH_RANGE;
+    loadChunkRange(range);
+    EntityState* store = gameState->entities;
+    float minX = range.startX * CHUNK_PIXEL_SIZE, spanX = (range.endX - range.startX + 1) * CHUNK_PIXEL_SIZE;
+    float minY = range.startY * CHUNK_PIXEL_SIZE, spanY = (range.endY - range.startY + 1) * CHUNK_PIXEL_SIZE;
+
+    uint32_t random = 0x85ebca6bu;
+    spawnBenchEntities(&random, range, ENTITY_BENCH_COUNT);
+    int badAfterSpawn = countBadEntities(store);
+
+    // Items and mobs stop at walls, projectiles break on them, and some
+    // wander off into unloaded chunks, so keep the crowd going
+    double updateSeconds = 0.0, pairSeconds = 0.0;
+    uint64_t pairTotal = 0;
+    for (int tick = 0; tick < ENTITY_BENCH_TICKS; tick++) {
+        if (tick % 30 == 0) {
+            spawnBenchEntities(&random, range, ENTITY_BENCH_COUNT - store->activeCount);
+            for (int i = 0; i < store->activeCount; i++) {
+                if (store->velocities[i].x == 0.0f || store->velocities[i].y == 0.0f) {
+                    store->velocities[i] = randomEntityVelocity(&random);
+                }
+            }
+        }
+        double start = nowSeconds();
+        updateEntities(SIM_DT);
+        updateSeconds += nowSeconds() - start;
+        start = nowSeconds();
+        pairTotal += (uint64_t)findEntityPairs(pairs, ENTITY_BENCH_MAX_PAIRS);
+        pairSeconds += nowSeconds() - start;
+    }
+    report->seconds = updateSeconds;
+    int activeAfterTicks = store->activeCount;
+    int badAfterTicks = countBadEntities(store);
+
+    int pairCount = 0;
+    int badPairs = countBadPairs(store, pairs, &pairCount);
+
+    // Neighbour queries against a scan of every active entity
+    int badQueries = 0;
+    double querySeconds = 0.0;
+    for (int q = 0; q < ENTITY_BENCH_QUERIES; q++) {
+        Vector2 center = {wrapWorldX(randomRange(&random, minX, minX + spanX)), randomRange(&random, minY, minY + spanY)};
+        float radius = randomRange(&random, 4.0f, 96.0f);
+        double start = nowSeconds();
+        int count = queryEntities(center, radius, found, ENTITY_CAPACITY);
+        querySeconds += nowSeconds() - start;
+
+        int expected = 0;
+        for (int i = 0; i < store->activeCount; i++) {
+            float dx = fabsf(store->positions[i].x - center.x);
+            if (dx > WORLD_WIDTH_PIXELS / 2) dx = WORLD_WIDTH_PIXELS - dx;
+            dx = fmaxf(dx - store->halfSizes[i].x, 0.0f);
+            float dy = fmaxf(fabsf(store->positions[i].y - center.y) - store->halfSizes[i].y, 0.0f);
+            expected += dx * dx + dy * dy <= radius * radius;
+        }
+        badQueries += count != expected;
+    }
+
+    // Unload the left half: its entities park and hold still, then wake
+    // when it is loaded again
+    Vector2 keep = {(range.endX - 4.5f) * CHUNK_PIXEL_SIZE, (range.startY + range.endY + 1) / 2.0f * CHUNK_PIXEL_SIZE};
+    unloadDistantChunks(keep, 5);
+    updateEntities(SIM_DT);
+    int parkedCount = store->count - store->activeCount;
+    int badAfterUnload = countBadEntities(store);
+
+    static Vector2 parkedPositions[ENTITY_CAPACITY];
+    static EntityId parkedIds[ENTITY_CAPACITY];
+    for (int i = store->activeCount; i < store->count; i++) {
+        parkedIds[i - store->activeCount] = store->ids[i];
+        parkedPositions[i - store->activeCount] = store->positions[i];
+    }
+    for (int tick = 0; tick < 30; tick++) updateEntities(SIM_DT);
+    int movedWhileParked = 0;
+    for (int i = 0; i < parkedCount; i++) {
+        int index = getEntityIndex(parkedIds[i]);
+        movedWhileParked += index < store->activeCount || store->positions[index].x != parkedPositions[i].x ||
+                            store->positions[index].y != parkedPositions[i].y;
+    }
+
+    loadChunkRange(range);
+    updateEntities(SIM_DT);
+    int badAfterReload = countBadEntities(store);
+    EntityStats stats = getEntityStats();
+
+    int bad = badAfterSpawn + badAfterTicks + badPairs + badQueries + badAfterUnload + movedWhileParked + badAfterReload;
+    report->passed = bad == 0 && parkedCount > 0;
+    report->operations = (uint64_t)ENTITY_BENCH_TICKS;
+    snprintf(report->unit, sizeof(report->unit), "ticks");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d active: %.2f ms per update, broadphase %.2f ms (%.0f pairs), %.2f us per query; "
+             "%llu rebucketed; %d parked on unload, %d moved; bad entities/pairs/queries: %d/%d/%d",
+             activeAfterTicks, updateSeconds * 1000.0 / ENTITY_BENCH_TICKS, pairSeconds * 1000.0 / ENTITY_BENCH_TICKS,
+             (double)pairTotal / ENTITY_BENCH_TICKS, querySeconds * 1e6 / ENTITY_BENCH_QUERIES, (unsigned long long)stats.rebucketed,
+             parkedCount, movedWhileParked, badAfterSpawn + badAfterTicks + badAfterUnload + badAfterReload, badPairs,
+             badQueries);
+    return report->passed;
+}
+
+// --- Decoration: unload and reload in random order, same world every time ---
+
+#define DECORATION_BENCH_RANGE ((ChunkRange){-8, 4, 7, 19}) // Across the seam, surface down into the caves
+#define DECORATION_ROUNDS 100
+#define DECORATION_MAX_KEEP_RADIUS 6
+
+// Creates the missing chunks of the range in a shuffled order, so runs
+// cross borders both ways: into loaded chunks and into queues
+static int loadChunkRangeShuffled(ChunkRange range, uint32_t* random) {
+    static ChunkCoord coords[CHUNK_POOL_CAPACITY];
+    int count = 0;
+    for (int x = range.startX; x <= range.endX; x++) {
+        for (int y = range.startY; y <= range.endY; y++) {
+            if (!getChunk(x, y)) coords[count++] = (ChunkCoord){x, y};
+        }
+    }
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(nextRandom(random) % (uint32_t)(i + 1));
+        ChunkCoord swap = coords[i];
+        coords[i] = coords[j];
+        coords[j] = swap;
+    }
+    for (int i = 0; i < count; i++) createChunk(coords[i].x, coords[i].y);
+    return count;
+}
+
+static int checkDecorations(GameState* gameState, BenchReport* report) {
+    ChunkRange range = DECORATION_BENCH_RANGE;
+    Vector2 rangeCenter = {(range.startX + range.endX + 1) / 2.0f * CHUNK_PIXEL_SIZE,
+                           (range.startY + range.endY + 1) / 2.0f * CHUNK_PIXEL_SIZE};
+    unloadDistantChunks(rangeCenter, -1);
+    loadChunkRange(range);
+    uint64_t expected = hashChunkRange(range);
+
+    // Keep a random square, drop the rest, and bring the range back
+    uint32_t random = 0x9e3779b9u;
+    int mismatches = 0;
+    int peakPending = 0;
+    uint64_t regenerated = 0;
+    double start = nowSeconds();
+    for (int round = 0; round < DECORATION_ROUNDS; round++) {
+        Vector2 keep = {
+            (range.startX + (int)(nextRandom(&random) % (uint32_t)(range.endX - range.startX + 1)) + 0.5f) * CHUNK_PIXEL_SIZE,
+            (range.startY + (int)(nextRandom(&random) % (uint32_t)(range.endY - range.startY + 1)) + 0.5f) * CHUNK_PIXEL_SIZE,
+        };
+        unloadDistantChunks(keep, (int)(nextRandom(&random) % DECORATION_MAX_KEEP_RADIUS) - 1);
+        int pending = getDecorationStats().pendingChunks;
+        if (pending > peakPending) peakPending = pending;
+        regenerated += loadChunkRangeShuffled(range, &random);
+        mismatches += hashChunkRange(range) != expected;
+    }
+    report->seconds = nowSeconds() - start;
+
+    unloadDistantChunks(rangeCenter, -1);
+    DecorationStats stats = getDecorationStats();
+
+    report->passed = mismatches == 0 && stats.pendingChunks == 0 && stats.droppedRuns == 0;
+    report->operations = regenerated;
+    snprintf(report->unit, sizeof(report->unit), "chunks");
+    snprintf(report->detail, sizeof(report->detail),
+             "%d rounds, %d changed the world; %llu runs queued, %llu dropped; "
+             "peak %d queues after unloading, %d left with nothing loaded",
+             DECORATION_ROUNDS, mismatches, (unsigned long long)stats.queuedRuns,
+             (unsigned long long)stats.droppedRuns, peakPending, stats.pendingChunks);
+    return report->passed;
+}
+
+static const BenchEntry benches[] = {
+    {"liquid", benchLiquid},
+    {"liquid-determinism", checkLiquidDeterminism},
+    {"jobs", checkJobs},
+    {"occupancy", benchOccupancy},
+    {"collision", benchCollision},
+    {"raycast", benchRaycast},
+    {"edit", benchEdit},
+    {"light", benchLight},
+    {"path", benchPath},
+    {"entities", benchEntities},
+    {"decoration", checkDecorations},
+};
+
+EXPORT int gameBenchmark(GameState* gameState, const char* name, BenchReport* report) {
+    bindGameState(gameState);
+    memset(report, 0, sizeof(*report));
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (strcmp(benches[i].name, name) == 0) return benches[i].run(gameState, report);
+    }
+
+    snprintf(report->detail, sizeof(report->detail), "Unknown benchmark '%s'", name);
+    return 0;
+}
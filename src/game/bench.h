@@ -0,0 +1,8 @@
+#pragma once
+
+#include "game_state.h"
+#include "game_api.h"
+
+// Runs the named benchmark or check against gameState. Returns 0 for an
+// unknown name or a failed check, with the reason in report->detail.
+EXPORT int gameBenchmark(GameState* gameState, const char* name, BenchReport* report);
@@ -0,0 +1,97 @@
+#include "biome.h"
+#include "world_gen.h"
+#include "noise.h"
+
+// Offsets applied on top of WorldGenParams
+typedef struct BiomeDef
+{
+    const char* name;
+    float surfaceOffset;  // Tiles, positive is lower
+    float amplitudeScale;
+    float caveBias;       // Added to caveThreshold, negative means more caves
+    float liquidBias;     // Added to waterThreshold, negative means more pools
+    bool lava;
+} BiomeDef;
+
+static const BiomeDef biomeDefs[BIOME_COUNT] = {
+    [BIOME_PLAINS] = {"Plains", 6.0f, 0.4f, 0.05f, 0.0f, false},
+    [BIOME_HILLS] = {"Hills", -12.0f, 1.4f, 0.0f, 0.05f, false},
+    [BIOME_CAVERNS] = {"Caverns", 0.0f, 0.8f, -0.15f, -0.05f, false},
+    [BIOME_VOLCANIC] = {"Volcanic", 0.0f, 1.0f, -0.05f, -0.15f, true},
+};
+
+static BiomeCache* cache = NULL;
+
+void bindBiomeCache(BiomeCache* newCache) {
+    cache = newCache;
+}
+
+static BiomeType pickBiome(float temperature, float humidity) {
+    if (temperature > 0.2f) {
+        return (humidity < 0.0f) ? BIOME_VOLCANIC : BIOME_HILLS;
+    }
+    return (humidity > 0.15f) ? BIOME_CAVERNS : BIOME_PLAINS;
+}
+
+static const BiomeColumn* getColumn(int chunkX) {
+    chunkX = wrapChunkX(chunkX);
+
+    // Params changed: every column is stale
+    uint64_t hash = getWorldGenHash();
+    if (hash != cache->hash) {
+        for (int i = 0; i < WORLD_WIDTH_CHUNKS; i++) cache->columns[i].valid = false;
+        cache->hash = hash;
+    }
+
+    BiomeColumn* column = &cache->columns[chunkX];
+    if (column->valid) return column;
+
+    const WorldGenParams* params = getWorldGenParams();
+    uint32_t seed = getWorldGenLayerSeed(WORLD_GEN_LAYER_CLIMATE);
+
+    // Domain warp: displace the lookup position by another, coarser noise
+    float u = (float)chunkX / WORLD_WIDTH_CHUNKS;
+    float warp = sampleWrappedNoise(u, 0.5f, params->biomeWarpPeriod, seed ^ 0x5bd1e995u);
+    float warpedU = u + warp * params->biomeWarp;
+
+    float temperature = sampleWrappedNoise(warpedU, 1.5f, params->biomePeriod, seed);
+    float humidity = sampleWrappedNoise(warpedU, 7.5f, params->biomePeriod, seed ^ 0x27d4eb2du);
+
+    column->biome = pickBiome(temperature, humidity);
+    const BiomeDef* def = &biomeDefs[column->biome];
+    column->params = (BiomeParams){
+        .surfaceLevel = params->surfaceLevel + def->surfaceOffset,
+        .surfaceAmplitude = params->surfaceAmplitude * def->amplitudeScale,
+        .caveThreshold = params->caveThreshold + def->caveBias,
+        .liquidThreshold = params->waterThreshold + def->liquidBias,
+        .lava = def->lava ? 1.0f : 0.0f,
+    };
+    column->valid = true;
+    return column;
+}
+
+void sampleBiomeColumns(int chunkX, BiomeParams out[CHUNK_SIZE]) {
+    BiomeParams left = getColumn(chunkX)->params;
+    BiomeParams right = getColumn(chunkX + 1)->params;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        float t = (float)x / CHUNK_SIZE;
+        out[x] = (BiomeParams){
+            .surfaceLevel = left.surfaceLevel + (right.surfaceLevel - left.surfaceLevel) * t,
+            .surfaceAmplitude = left.surfaceAmplitude + (right.surfaceAmplitude - left.surfaceAmplitude) * t,
+            .caveThreshold = left.caveThreshold + (right.caveThreshold - left.caveThreshold) * t,
+            .liquidThreshold = left.liquidThreshold + (right.liquidThreshold - left.liquidThreshold) * t,
+            // Liquid type doesn't blend; the nearer sample wins
+            .lava = (t < 0.5f) ? left.lava : right.lava,
+        };
+    }
+}
+
+BiomeType getBiomeAt(int chunkX) {
+    return getColumn(chunkX)->biome;
+}
+
+const char* getBiomeName(BiomeType biome) {
+    if (biome < 0 || biome >= BIOME_COUNT) return "Unknown";
+    return biomeDefs[biome].name;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "chunk.h"
+
+// Coarse climate layer. Temperature and humidity are sampled once per
+// chunk column, at the column's left edge, in domain-warped coordinates so
+// biome borders don't line up with the noise lattice. Each sample picks a
+// biome, and generation interpolates the biome's parameters per tile
+// column instead of paying for extra noise per tile.
+
+typedef enum BiomeType
+{
+    BIOME_PLAINS,
+    BIOME_HILLS,
+    BIOME_CAVERNS,
+    BIOME_VOLCANIC,
+    BIOME_COUNT
+} BiomeType;
+
+// Generation parameters a biome drives, already combined with WorldGenParams
+typedef struct BiomeParams
+{
+    float surfaceLevel;
+    float surfaceAmplitude;
+    float caveThreshold;
+    float liquidThreshold;
+    float lava; // 1 where pools are lava instead of water
+} BiomeParams;
+
+typedef struct BiomeColumn
+{
+    BiomeType biome;
+    BiomeParams params;
+    bool valid;
+} BiomeColumn;
+
+// Per-chunk-column results, allocated once from the host's arena. Stale
+// whenever the world-gen hash no longer matches.
+typedef struct BiomeCache
+{
+    BiomeColumn columns[WORLD_WIDTH_CHUNKS];
+    uint64_t hash;
+} BiomeCache;
+
+void bindBiomeCache(BiomeCache* cache);
+
+// Interpolated parameters for each tile column of a chunk column
+void sampleBiomeColumns(int chunkX, BiomeParams out[CHUNK_SIZE]);
+
+BiomeType getBiomeAt(int chunkX);
+const char* getBiomeName(BiomeType biome);
@@ -1,14 +1,22 @@
 #include "chunk.h"
 #include "level_generator.h"
+#include "noise.h"
+#include "world_gen.h"
+#include "decoration.h"
+#include "biome.h"
+#include "chunk_render.h"
+#include "liquid.h"
+#include "occupancy.h"
+#include "light.h"
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
 
-#ifndef PI
-#define PI 3.14159265358979323846f
+#if CHUNK_SIZE != NOISE_BATCH_COLUMNS || CHUNK_SIZE != NOISE_BATCH_ROWS
+#error "Chunk generation assumes one chunk is one noise batch"
 #endif
 
-static ChunkMap chunkMap = {0};
+static ChunkSystem* chunks = NULL;
 
 // Hash function for chunk coordinates
 static unsigned int hashChunkCoord(int x, int y) {
@@ -33,20 +41,27 @@ float wrapWorldX(float worldX) {
     return worldX;
 }
 
-void initChunkSystem() {
-    memset(&chunkMap, 0, sizeof(ChunkMap));
+void initChunkSystem(ChunkSystem* system) {
+    memset(system->buckets, 0, sizeof(system->buckets));
+    memset(&system->stats, 0, sizeof(system->stats));
+    system->editEpoch = 0;
+    
+    system->freeList = NULL;
+    for (int i = CHUNK_POOL_CAPACITY - 1; i >= 0; i--) {
+        system->pool[i].next = system->freeList;
+        system->freeList = &system->pool[i];
+    }
+    chunks = system;
+}
+
+void bindChunkSystem(ChunkSystem* system) {
+    chunks = system;
 }
 
+// Storage stays with the host; only GPU resources need releasing
 void destroyChunkSystem() {
-    for (int i = 0; i < CHUNK_MAP_SIZE; i++) {
-        ChunkNode* node = chunkMap.buckets[i];
-        while (node) {
-            ChunkNode* next = node->next;
-            free(node);
-            node = next;
-        }
-        chunkMap.buckets[i] = NULL;
-    }
+    destroyChunkRender();
+    chunks = NULL;
 }
 
 Chunk* getChunk(int chunkX, int chunkY) {
@@ -54,7 +69,7 @@ Chunk* getChunk(int chunkX, int chunkY) {
     chunkX = wrapChunkX(chunkX);
     
     unsigned int hash = hashChunkCoord(chunkX, chunkY);
-    ChunkNode* node = chunkMap.buckets[hash];
+    ChunkNode* node = chunks->buckets[hash];
     
     // Search for existing chunk
     while (node) {
@@ -77,19 +92,35 @@ Chunk* createChunk(int chunkX, int chunkY) {
     if (existing) return existing;
     
     // Create new chunk (separate function for controlled creation)
-    ChunkNode* newNode = malloc(sizeof(ChunkNode));
-    if (!newNode) return NULL;
+    ChunkNode* newNode = chunks->freeList;
+    if (!newNode) {
+        chunks->stats.poolFull++;
+        return NULL;
+    }
+    chunks->freeList = newNode->next;
     
     newNode->chunk.x = chunkX;
     newNode->chunk.y = chunkY;
     newNode->chunk.generated = false;
     newNode->chunk.loaded = true;
+    newNode->chunk.version = 0;
+    newNode->chunk.dirty = (ChunkDirty){.empty = true};
+    resetChunkRender(&newNode->chunk);
+    newNode->chunk.summary.valid = false;
+    newNode->chunk.summary.lightValid = false;
+    memset(&newNode->chunk.liquid, 0, sizeof(newNode->chunk.liquid));
+    memset(&newNode->chunk.light, 0, sizeof(newNode->chunk.light));
+    newNode->chunk.nav.built = false;
+    newNode->chunk.nav.checkedQuery = 0;
     memset(newNode->chunk.tiles, TILE_AIR, sizeof(newNode->chunk.tiles));
+    memset(newNode->chunk.solid, 0, sizeof(newNode->chunk.solid));
     
     // Insert at head of bucket
     unsigned int hash = hashChunkCoord(chunkX, chunkY);
-    newNode->next = chunkMap.buckets[hash];
-    chunkMap.buckets[hash] = newNode;
+    newNode->next = chunks->buckets[hash];
+    chunks->buckets[hash] = newNode;
+    chunks->stats.created++;
+    chunks->stats.resident++;
     
     // Generate the chunk
     generateChunk(&newNode->chunk);
@@ -100,52 +131,155 @@ Chunk* createChunk(int chunkX, int chunkY) {
 void generateChunk(Chunk* chunk) {
     if (chunk->generated) return;
     
+    const NoiseProgram* program = getTerrainProgram();
+    if (!program->valid) return;
+    
     // Convert chunk coordinates to world coordinates
     int worldStartX = chunk->x * CHUNK_SIZE;
     int worldStartY = chunk->y * CHUNK_SIZE;
     
-    // For seamless wrapping, we need to ensure noise is periodic
-    // Use wrapped coordinates that ensure continuity at boundaries
+    // Thresholds come from the coarse biome layer, interpolated per column
+    BiomeParams biome[CHUNK_SIZE];
+    sampleBiomeColumns(chunk->x, biome);
+    
+    // The whole chunk is one batch, laid out like tiles[x][y]
+    float channels[NOISE_INPUT_COUNT][NOISE_BATCH_SIZE];
+    float tileValues[NOISE_BATCH_SIZE];
+    
     for (int x = 0; x < CHUNK_SIZE; x++) {
+        // Map world X to [0, 1) around the world so noise wraps at the seam
+        float columnU = (float)(worldStartX + x) / WORLD_WIDTH_TILES;
         for (int y = 0; y < CHUNK_SIZE; y++) {
-            int localWorldX = worldStartX + x;
-            int worldY = worldStartY + y;
-            
-            // Create seamless noise by using wrapped coordinates
-            // Map world coordinates to 0-1 range for periodic noise
-            float normalizedX = (float)localWorldX / WORLD_WIDTH_PIXELS;
-            float noiseX = cos(normalizedX * 2 * PI); // Convert to periodic
-            float noiseX2 = sin(normalizedX * 2 * PI);
-            
-            // Surface generation (seamless across world boundaries)
-            float height = stb_perlin_noise3(noiseX * 4, noiseX2 * 4, 0, 0, 0, 0) * 30.0f;
-            int surface_y = (int)(128 + height);
-            
-            if (worldY >= surface_y) {
-                chunk->tiles[x][y] = (worldY < surface_y + 3) ? TILE_DIRT : TILE_ROCK;
-            } else {
-                chunk->tiles[x][y] = TILE_AIR;
-            }
-            
-            // Simplified cave generation (also seamless)
-            if (chunk->tiles[x][y] != TILE_AIR && worldY > 140) {
-                float cave_noise = stb_perlin_noise3(noiseX * 8, worldY * 0.02f, noiseX2 * 8, 0, 0, 0);
-                if (cave_noise > 0.3f) {
-                    chunk->tiles[x][y] = TILE_AIR;
-                }
-            }
-            
-            // Add some water in very deep areas
-            if (chunk->tiles[x][y] == TILE_AIR && worldY > 200) {
-                float water_noise = stb_perlin_noise3(noiseX * 12, worldY * 0.05f, noiseX2 * 12, 0, 0, 0);
-                if (water_noise > 0.6f) {
-                    chunk->tiles[x][y] = TILE_WATER;
-                }
-            }
+            int lane = x * CHUNK_SIZE + y;
+            channels[NOISE_INPUT_U][lane] = columnU;
+            channels[NOISE_INPUT_Y][lane] = (float)(worldStartY + y);
+            channels[NOISE_INPUT_SURFACE_LEVEL][lane] = biome[x].surfaceLevel;
+            channels[NOISE_INPUT_SURFACE_AMPLITUDE][lane] = biome[x].surfaceAmplitude;
+            channels[NOISE_INPUT_CAVE_THRESHOLD][lane] = biome[x].caveThreshold;
+            channels[NOISE_INPUT_LIQUID_THRESHOLD][lane] = biome[x].liquidThreshold;
+            channels[NOISE_INPUT_LAVA][lane] = biome[x].lava;
         }
     }
     
+    const float* inputs[NOISE_INPUT_COUNT];
+    for (int ch = 0; ch < NOISE_INPUT_COUNT; ch++) inputs[ch] = channels[ch];
+    runNoiseProgram(program, inputs, tileValues);
+    
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            chunk->tiles[x][y] = (TileType)(int)tileValues[x * CHUNK_SIZE + y];
+        }
+    }
+    
+    chunk->genKey = getChunkGenerationKey(chunk->x, chunk->y);
     chunk->generated = true;
+    chunks->stats.generated++;
+    
+    // Structures can cross borders, so this also writes into loaded
+    // neighbours and picks up what they queued for this chunk
+    decorateChunk(chunk);
+    rebuildSolidMask(chunk);
+    
+    // Generated pools aren't necessarily resting; let them settle
+    wakeChunkLiquids(chunk);
+    lightChunk(chunk);
+}
+
+// Offset of each LOD's cells inside ChunkSummary.cells
+static const int summaryOffsets[CHUNK_LOD_COUNT] = {0, 0, 64, 80, 84};
+
+// Most common type in a block. Air only wins outright, so a block that is
+// half ground still reads as ground from far away.
+static uint8_t dominantTile(const uint16_t counts[TILE_TYPE_COUNT]) {
+    int best = TILE_AIR + 1;
+    for (int tile = best + 1; tile < TILE_TYPE_COUNT; tile++) {
+        if (counts[tile] > counts[best]) best = tile;
+    }
+    return (counts[TILE_AIR] > counts[best]) ? TILE_AIR : (uint8_t)best;
+}
+
+// Counts tiles per 2x2 block once, then sums counts upwards, so every
+// level is exact rather than a mode of modes
+static void buildChunkSummary(Chunk* chunk) {
+    uint16_t counts[8 * 8][TILE_TYPE_COUNT];
+    memset(counts, 0, sizeof(counts));
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            counts[(x >> 1) * 8 + (y >> 1)][chunk->tiles[x][y]]++;
+        }
+    }
+
+    for (int lod = 1; lod < CHUNK_LOD_COUNT; lod++) {
+        int size = CHUNK_SIZE >> lod;
+        uint8_t* cells = chunk->summary.cells + summaryOffsets[lod];
+        for (int i = 0; i < size * size; i++) cells[i] = dominantTile(counts[i]);
+
+        // Fold 2x2 cells into the next level, in place: the target index
+        // never exceeds any source index still to be read
+        int next = size >> 1;
+        for (int x = 0; x < next; x++) {
+            for (int y = 0; y < next; y++) {
+                uint16_t sum[TILE_TYPE_COUNT];
+                for (int tile = 0; tile < TILE_TYPE_COUNT; tile++) {
+                    sum[tile] = counts[(2 * x) * size + 2 * y][tile] + counts[(2 * x) * size + 2 * y + 1][tile] +
+                                counts[(2 * x + 1) * size + 2 * y][tile] + counts[(2 * x + 1) * size + 2 * y + 1][tile];
+                }
+                memcpy(counts[x * next + y], sum, sizeof(sum));
+            }
+        }
+    }
+
+    chunk->summary.version = chunk->version;
+    chunk->summary.valid = true;
+}
+
+const uint8_t* getChunkSummary(Chunk* chunk, int lod) {
+    if (lod < 1 || lod >= CHUNK_LOD_COUNT) return NULL;
+    if (!chunk->summary.valid || chunk->summary.version != chunk->version) buildChunkSummary(chunk);
+    return chunk->summary.cells + summaryOffsets[lod];
+}
+
+void markChunkChanged(Chunk* chunk) {
+    chunk->version++;
+    chunk->dirty.sinceVersion = chunk->version;
+    chunk->dirty.empty = true;
+}
+
+void markChunkRegionChanged(Chunk* chunk, int minX, int minY, int maxX, int maxY) {
+    ChunkDirty* dirty = &chunk->dirty;
+    if (dirty->empty || dirty->epoch != chunks->editEpoch) {
+        *dirty = (ChunkDirty){
+            .epoch = chunks->editEpoch,
+            .sinceVersion = chunk->version,
+            .minX = (uint8_t)minX, .minY = (uint8_t)minY,
+            .maxX = (uint8_t)maxX, .maxY = (uint8_t)maxY,
+        };
+    } else {
+        if (minX < dirty->minX) dirty->minX = (uint8_t)minX;
+        if (minY < dirty->minY) dirty->minY = (uint8_t)minY;
+        if (maxX > dirty->maxX) dirty->maxX = (uint8_t)maxX;
+        if (maxY > dirty->maxY) dirty->maxY = (uint8_t)maxY;
+    }
+    chunk->version++;
+}
+
+void advanceChunkEditEpoch() {
+    chunks->editEpoch++;
+}
+
+bool getChunkChangesSince(const Chunk* chunk, uint32_t version, int* minX, int* minY, int* maxX, int* maxY) {
+    const ChunkDirty* dirty = &chunk->dirty;
+    if (dirty->empty || version < dirty->sinceVersion || version > chunk->version) return false;
+    *minX = dirty->minX;
+    *minY = dirty->minY;
+    *maxX = dirty->maxX;
+    *maxY = dirty->maxY;
+    return true;
+}
+
+ChunkStats getChunkStats() {
+    return chunks->stats;
 }
 
 Vector2 worldToChunkCoord(Vector2 worldPos) {
@@ -204,7 +338,7 @@ void unloadDistantChunks(Vector2 worldPos, int unloadRadius) {
     Vector2 centerChunk = worldToChunkCoord(worldPos);
     
     for (int i = 0; i < CHUNK_MAP_SIZE; i++) {
-        ChunkNode** nodePtr = &chunkMap.buckets[i];
+        ChunkNode** nodePtr = &chunks->buckets[i];
         
         while (*nodePtr) {
             ChunkNode* node = *nodePtr;
@@ -220,7 +354,11 @@ void unloadDistantChunks(Vector2 worldPos, int unloadRadius) {
             if (dx > unloadRadius || dy > unloadRadius) {
                 // Unload this chunk
                 *nodePtr = node->next;
-                free(node);
+                node->next = chunks->freeList;
+                chunks->freeList = node;
+                chunks->stats.unloaded++;
+                chunks->stats.resident--;
+                releaseChunkDecorations(node->chunk.x, node->chunk.y);
             } else {
                 nodePtr = &node->next;
             }
@@ -228,83 +366,100 @@ void unloadDistantChunks(Vector2 worldPos, int unloadRadius) {
     }
 }
 
-void drawChunks(Camera2D camera) {
-    // Calculate which chunks are visible
-    Vector2 screenSize = {GetScreenWidth(), GetScreenHeight()};
+int getMaxUnloadRadius() {
+    int radius = 0;
+    for (;;) {
+        int side = 2 * (radius + 1) + 1;
+        int width = (side < WORLD_WIDTH_CHUNKS) ? side : WORLD_WIDTH_CHUNKS;
+        if (width * side > CHUNK_POOL_CAPACITY) return radius;
+        radius++;
+    }
+}
+
+ChunkRange getVisibleChunkRange(Camera2D camera, Vector2 viewSize) {
     Vector2 topLeft = GetScreenToWorld2D((Vector2){0, 0}, camera);
-    Vector2 bottomRight = GetScreenToWorld2D(screenSize, camera);
-    
-    // Calculate chunk ranges - handle wrapping by using unwrapped coordinates
-    int startChunkX = (int)floorf(topLeft.x / CHUNK_PIXEL_SIZE) - 1;
-    int endChunkX = (int)floorf(bottomRight.x / CHUNK_PIXEL_SIZE) + 1;
-    int startChunkY = (int)floorf(topLeft.y / CHUNK_PIXEL_SIZE) - 1;
-    int endChunkY = (int)floorf(bottomRight.y / CHUNK_PIXEL_SIZE) + 1;
+    Vector2 bottomRight = GetScreenToWorld2D(viewSize, camera);
     
-    BeginMode2D(camera);
+    // Unwrapped coordinates, so a view across the seam stays contiguous
+    return (ChunkRange){
+        (int)floorf(topLeft.x / CHUNK_PIXEL_SIZE),
+        (int)floorf(topLeft.y / CHUNK_PIXEL_SIZE),
+        (int)floorf(bottomRight.x / CHUNK_PIXEL_SIZE),
+        (int)floorf(bottomRight.y / CHUNK_PIXEL_SIZE)
+    };
+}
+
+// Creates at most budget missing chunks in the range, nearest to the
+// center first. Returns what is left of the budget. Stops early, without
+// charging for it, once the pool is full; the next unload frees nodes.
+static int streamChunkRange(ChunkRange range, int centerX, int centerY, int budget) {
+    int maxRing = 0;
+    int extents[4] = {centerX - range.startX, range.endX - centerX, centerY - range.startY, range.endY - centerY};
+    for (int i = 0; i < 4; i++) {
+        if (extents[i] > maxRing) maxRing = extents[i];
+    }
     
-    // Draw visible chunks - iterate through actual coordinates, not wrapped ones
-    for (int chunkX = startChunkX; chunkX <= endChunkX; chunkX++) {
-        for (int chunkY = startChunkY; chunkY <= endChunkY; chunkY++) {
-            // Get/create chunk using wrapped coordinates for storage
-            int wrappedChunkX = wrapChunkX(chunkX);
-            
-            // Look up existing chunk
-            unsigned int hash = hashChunkCoord(wrappedChunkX, chunkY);
-            ChunkNode* node = chunkMap.buckets[hash];
+    for (int ring = 0; ring <= maxRing && budget > 0; ring++) {
+        for (int chunkX = centerX - ring; chunkX <= centerX + ring && budget > 0; chunkX++) {
+            if (chunkX < range.startX || chunkX > range.endX) continue;
             
-            Chunk* chunk = NULL;
-            while (node) {
-                if (node->chunk.x == wrappedChunkX && node->chunk.y == chunkY) {
-                    chunk = &node->chunk;
-                    break;
-                }
-                node = node->next;
-            }
-            
-            // If chunk doesn't exist, create it with wrapped coordinates
-            if (!chunk) {
-                ChunkNode* newNode = malloc(sizeof(ChunkNode));
-                if (!newNode) continue;
-                
-                newNode->chunk.x = wrappedChunkX;
-                newNode->chunk.y = chunkY;
-                newNode->chunk.generated = false;
-                newNode->chunk.loaded = true;
-                memset(newNode->chunk.tiles, TILE_AIR, sizeof(newNode->chunk.tiles));
+            // Interior cells of the ring were covered by smaller rings
+            bool edgeColumn = (chunkX == centerX - ring || chunkX == centerX + ring);
+            int step = edgeColumn ? 1 : 2 * ring;
+            for (int chunkY = centerY - ring; chunkY <= centerY + ring && budget > 0; chunkY += (step > 0 ? step : 1)) {
+                if (chunkY < range.startY || chunkY > range.endY) continue;
+                if (getChunk(chunkX, chunkY)) continue;
                 
-                // Insert at head of bucket
-                newNode->next = chunkMap.buckets[hash];
-                chunkMap.buckets[hash] = newNode;
-                
-                chunk = &newNode->chunk;
-                generateChunk(chunk);
+                if (!createChunk(chunkX, chunkY)) return budget;
+                budget--;
             }
-            
+        }
+    }
+    return budget;
+}
+
+void updateChunkStreaming(Camera2D camera, Vector2 viewSize) {
+    ChunkRange visible = getVisibleChunkRange(camera, viewSize);
+    int centerX = (visible.startX + visible.endX) / 2;
+    int centerY = (visible.startY + visible.endY) / 2;
+    
+    // Everything on screen first, then the margin around it
+    int budget = streamChunkRange(visible, centerX, centerY, CHUNK_STREAM_BUDGET);
+    if (!chunks->freeList) return;
+    ChunkRange prefetch = {
+        visible.startX - CHUNK_PREFETCH_MARGIN, visible.startY - CHUNK_PREFETCH_MARGIN,
+        visible.endX + CHUNK_PREFETCH_MARGIN, visible.endY + CHUNK_PREFETCH_MARGIN
+    };
+    streamChunkRange(prefetch, centerX, centerY, budget);
+}
+
+// Read-only: draws whatever is resident and leaves missing chunks to
+// updateChunkStreaming
+void drawChunks(Camera2D camera) {
+    Vector2 screenSize = {GetScreenWidth(), GetScreenHeight()};
+    ChunkRange visible = getVisibleChunkRange(camera, screenSize);
+    
+    beginChunkRender(visible.startX, visible.startY, visible.endX, visible.endY, camera.zoom);
+    BeginMode2D(camera);
+    
+    // Iterate through unwrapped coordinates so the world repeats across the seam
+    for (int chunkX = visible.startX; chunkX <= visible.endX; chunkX++) {
+        for (int chunkY = visible.startY; chunkY <= visible.endY; chunkY++) {
+            Chunk* chunk = getChunk(chunkX, chunkY);
             if (!chunk || !chunk->generated) continue;
             
-            // Draw tiles using the ORIGINAL (unwrapped) chunk coordinates for positioning
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                for (int y = 0; y < CHUNK_SIZE; y++) {
-                    if (chunk->tiles[x][y] == TILE_AIR) continue;
-                    
-                    // Use original chunkX for positioning - this allows wrapping display
-                    int worldX = chunkX * CHUNK_PIXEL_SIZE + x * TILE_SIZE;
-                    int worldY = chunkY * CHUNK_PIXEL_SIZE + y * TILE_SIZE;
-                    
-                    Color color = GRAY;
-                    switch (chunk->tiles[x][y]) {
-                        case TILE_DIRT: color = BROWN; break;
-                        case TILE_ROCK: color = GRAY; break;
-                        case TILE_WATER: color = BLUE; break;
-                        case TILE_LAVA: color = ORANGE; break;
-                        default: break;
-                    }
-                    
-                    DrawRectangle(worldX, worldY, TILE_SIZE, TILE_SIZE, color);
-                }
-            }
+            // Draw at the unwrapped position; storage uses the wrapped one
+            drawChunkTiles(chunk, chunkX, chunkY);
         }
     }
     
+    endChunkRender();
+    
+    for (int chunkX = visible.startX; chunkX <= visible.endX; chunkX++) {
+        for (int chunkY = visible.startY; chunkY <= visible.endY; chunkY++) {
+            Chunk* chunk = getChunk(chunkX, chunkY);
+            if (chunk && chunk->generated) drawChunkLight(chunk, chunkX, chunkY);
+        }
+    }
     EndMode2D();
-} 
+}
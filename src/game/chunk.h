@@ -3,6 +3,7 @@
 #include <raylib.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "export.h"
 #include "level.h" // Use existing TileType and TILE_SIZE
 
@@ -11,32 +12,158 @@
 
 // World wrapping - horizontal wrapping like a planet
 #define WORLD_WIDTH_CHUNKS 64  // World is 64 chunks wide
+#define WORLD_WIDTH_TILES (WORLD_WIDTH_CHUNKS * CHUNK_SIZE)
 #define WORLD_WIDTH_PIXELS (WORLD_WIDTH_CHUNKS * CHUNK_PIXEL_SIZE)
 
+// Downsampled summaries: LOD n holds (CHUNK_SIZE >> n)^2 cells, each the
+// dominant tile type of its 2^n x 2^n block. LOD 0 is the tiles themselves.
+#define CHUNK_LOD_COUNT 5
+#define CHUNK_SUMMARY_CELLS (8 * 8 + 4 * 4 + 2 * 2 + 1)
+
+// Streaming: missing chunks created per update, and the ring of chunks
+// around the view loaded ahead of time
+#define CHUNK_STREAM_BUDGET 64
+#define CHUNK_PREFETCH_MARGIN 1
+
 // Hash table for chunk storage
-#define CHUNK_MAP_SIZE 256
+#define CHUNK_MAP_SIZE 2048
+
+// Chunks come from a fixed pool in the host's arena; creation fails once
+// this many are resident
+#define CHUNK_POOL_CAPACITY 8192
+
+// Per-chunk state owned by chunk_render.c
+typedef struct ChunkRenderState
+{
+  int atlasSlot; // -1 when not rasterized
+  int lightSlot; // Same, in the light atlas
+
+  // Greedy-merged rectangles, packed by packRenderRect
+  uint32_t rects[CHUNK_SIZE * CHUNK_SIZE];
+  uint16_t rectCount;
+  uint32_t rectsVersion;
+  bool rectsValid;
+} ChunkRenderState;
+
+typedef struct ChunkSummary
+{
+  uint8_t cells[CHUNK_SUMMARY_CELLS]; // LOD 1 to 4 back to back, column-major like tiles
+  uint32_t version;
+  bool valid;
+  uint8_t light[CHUNK_SUMMARY_CELLS]; // Mean light per cell, same layout; owned by chunk_render.c
+  uint32_t lightVersion;
+  bool lightValid;
+} ChunkSummary;
+
+// Per-chunk liquid state owned by liquid.c. Bit y * CHUNK_SIZE + x is
+// cell (x, y), row-major so a bottom-up scan walks the words downwards.
+#define CHUNK_CELL_WORDS (CHUNK_SIZE * CHUNK_SIZE / 64)
+
+typedef struct ChunkLiquid
+{
+  uint64_t active[CHUNK_CELL_WORDS];  // Cells being updated this tick
+  uint64_t pending[CHUNK_CELL_WORDS]; // Cells to update next tick
+  uint64_t listedTick; // Tick whose awake list this chunk is already in
+  uint64_t modifiedTick; // Last tick that moved liquid in this chunk
+  uint64_t lavaTick; // Last tick that moved or set lava in this chunk
+  uint64_t lavaCells[CHUNK_CELL_WORDS]; // Cells where lava moved or set, until lighting takes them
+} ChunkLiquid;
+
+// Per-chunk light owned by light.c: sky light in the high nibble of each
+// level, block light in the low one, column-major like tiles
+typedef struct ChunkLight
+{
+  uint8_t levels[CHUNK_SIZE][CHUNK_SIZE];
+  uint32_t version; // Bumped by every propagation pass that changes a level
+  uint64_t pass;    // Last pass that bumped version
+  bool lit;
+  bool openSky; // Lit with open sky assumed above, the chunk above not being loaded
+} ChunkLight;
+
+// Per-chunk abstract graph owned by pathfind.c. A border run of open
+// cells gets one portal, so a side has at most CHUNK_SIZE / 2.
+#define CHUNK_NAV_PORTALS (4 * CHUNK_SIZE / 2)
+
+typedef struct ChunkNav
+{
+  uint64_t solid[CHUNK_CELL_WORDS]; // The mask it was built from
+  uint16_t facing[4];               // The neighbours' open border cells it was built from, per side
+  uint8_t portalCount;
+  uint8_t portalCell[CHUNK_NAV_PORTALS]; // y * CHUNK_SIZE + x
+  uint8_t portalSide[CHUNK_NAV_PORTALS];
+  uint8_t sidePortals[4][CHUNK_SIZE]; // Portal at each offset along a side, or 0xff
+  uint8_t distance[CHUNK_NAV_PORTALS][CHUNK_NAV_PORTALS]; // Steps between portals, 0xff when unreachable
+  uint64_t checkedQuery; // Last query that validated it
+  bool built;
+} ChunkNav;
+
+// Every tile changed since sinceVersion lies in the inclusive rectangle,
+// so a consumer whose copy is at sinceVersion or later only needs that
+// part again. Edits in one epoch (a sim tick) grow the rectangle; the
+// first edit of a new epoch starts over, and a whole-chunk change leaves
+// it empty at the new version.
+typedef struct ChunkDirty
+{
+  uint64_t epoch;
+  uint32_t sinceVersion;
+  uint8_t minX, minY, maxX, maxY;
+  bool empty;
+} ChunkDirty;
 
 typedef struct Chunk
 {
   int x, y; // Chunk coordinates (not pixel coordinates)
   TileType tiles[CHUNK_SIZE][CHUNK_SIZE];
+  uint64_t solid[CHUNK_CELL_WORDS]; // Solid tiles, same bit layout as ChunkLiquid; see occupancy.h
+  uint64_t genKey; // Generation key of the contents, see getChunkGenerationKey
+  uint32_t version; // Bumped whenever tiles change after generation
+  ChunkDirty dirty;
+  ChunkRenderState render;
+  ChunkSummary summary;
+  ChunkLiquid liquid;
+  ChunkLight light;
+  ChunkNav nav;
   bool generated;
   bool loaded;
 } Chunk;
 
+// Inclusive range of unwrapped chunk coordinates
+typedef struct ChunkRange
+{
+  int startX, startY;
+  int endX, endY;
+} ChunkRange;
+
 typedef struct ChunkNode
 {
   Chunk chunk;
   struct ChunkNode* next;
 } ChunkNode;
 
-typedef struct ChunkMap
+// Lifetime counters, for hosts and benchmarks
+typedef struct ChunkStats
+{
+  uint64_t created;
+  uint64_t generated;
+  uint64_t unloaded;
+  uint64_t poolFull; // Creates turned away with every pool node in use
+  int resident;
+} ChunkStats;
+
+// Chunk storage and index, allocated once from the host's arena
+typedef struct ChunkSystem
 {
   ChunkNode* buckets[CHUNK_MAP_SIZE];
-} ChunkMap;
+  ChunkNode* freeList;
+  ChunkStats stats;
+  uint64_t editEpoch;
+  ChunkNode pool[CHUNK_POOL_CAPACITY];
+} ChunkSystem;
 
-// Chunk system functions
-void initChunkSystem();
+// Chunk system functions. init prepares fresh storage; bind points the
+// library at existing storage, which is all a hot reload needs.
+void initChunkSystem(ChunkSystem* system);
+void bindChunkSystem(ChunkSystem* system);
 void destroyChunkSystem();
 
 // Chunk management
@@ -46,6 +173,33 @@ void generateChunk(Chunk* chunk);
 void loadChunksAroundPosition(Vector2 worldPos, int loadRadius);
 void unloadDistantChunks(Vector2 worldPos, int unloadRadius);
 
+// The largest unload radius whose square of chunks, clipped to the world
+// width, fits CHUNK_POOL_CAPACITY
+int getMaxUnloadRadius();
+
+// Creates and generates chunks in and around the camera's view, within
+// CHUNK_STREAM_BUDGET per call. The only place chunks appear during play.
+void updateChunkStreaming(Camera2D camera, Vector2 viewSize);
+ChunkRange getVisibleChunkRange(Camera2D camera, Vector2 viewSize);
+
+// Tile changes after generation go through one of these, which bump the
+// version. markChunkChanged covers anything that may have touched the
+// whole chunk; markChunkRegionChanged takes the inclusive local rectangle
+// an edit stayed inside.
+void markChunkChanged(Chunk* chunk);
+void markChunkRegionChanged(Chunk* chunk, int minX, int minY, int maxX, int maxY);
+
+// Starts a new edit epoch; the game does this once per sim tick
+void advanceChunkEditEpoch();
+
+// For a consumer holding the chunk at `version`: true with the local
+// rectangle that changed since, false when it must refresh everything
+bool getChunkChangesSince(const Chunk* chunk, uint32_t version, int* minX, int* minY, int* maxX, int* maxY);
+
+// Dominant tile types at the given LOD (1 to CHUNK_LOD_COUNT - 1), rebuilt
+// when the chunk's version changed. Cell (x, y) is at x * (CHUNK_SIZE >> lod) + y.
+const uint8_t* getChunkSummary(Chunk* chunk, int lod);
+
 // Utility functions with wrapping support
 Vector2 worldToChunkCoord(Vector2 worldPos);
 Vector2 chunkToWorldCoord(int chunkX, int chunkY);
@@ -53,5 +207,7 @@ TileType getTileAt(float worldX, float worldY);
 int wrapChunkX(int chunkX); // Wrap chunk X coordinate
 float wrapWorldX(float worldX); // Wrap world X coordinate
 
-// Rendering
+ChunkStats getChunkStats();
+
+// Rendering, reads resident chunks only
 void drawChunks(Camera2D camera); 
@@ -0,0 +1,579 @@
+#include "chunk_render.h"
+#include "light.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+typedef struct VisibleRange
+{
+    int startX, startY, endX, endY;
+} VisibleRange;
+
+static ChunkRenderCache* cache = NULL;
+static VisibleRange visible = {0};
+static int frameLod = 0;
+static ChunkRenderMode renderMode = RENDER_MODE_ATLAS;
+static bool lightOverlay = true;
+
+static const char* renderModeNames[RENDER_MODE_COUNT] = {
+    [RENDER_MODE_ATLAS] = "atlas",
+    [RENDER_MODE_MERGED_RECTS] = "merged rects",
+    [RENDER_MODE_TILEMAP_SHADER] = "tile map shader",
+};
+
+// Plain GLSL 330 with texture() and a uniform array, nothing Mesa's
+// software rasterizer lacks. The default vertex shader is used.
+static const char* tileMapFragmentShader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 palette[8];\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    int tile = int(texture(texture0, fragTexCoord).r * 255.0 + 0.5);\n"
+    "    if (tile == 0) discard;\n"
+    "    finalColor = palette[min(tile, 7)] * fragColor;\n"
+    "}\n";
+
+// A merged rectangle: 4 bits each for x, y, width - 1 and height - 1, then the tile
+static inline uint32_t packRenderRect(int x, int y, int w, int h, TileType tile) {
+    return (uint32_t)x | ((uint32_t)y << 4) | ((uint32_t)(w - 1) << 8) | ((uint32_t)(h - 1) << 12) | ((uint32_t)tile << 16);
+}
+
+Color getTileColor(TileType tile) {
+    switch (tile) {
+        case TILE_DIRT: return BROWN;
+        case TILE_ROCK: return GRAY;
+        case TILE_WATER: return BLUE;
+        case TILE_LAVA: return ORANGE;
+        default: return BLANK;
+    }
+}
+
+void setChunkRenderMode(ChunkRenderMode mode) {
+    if (mode < 0 || mode >= RENDER_MODE_COUNT) return;
+    renderMode = mode;
+}
+
+void setChunkLightOverlay(bool enabled) {
+    lightOverlay = enabled;
+}
+
+ChunkRenderMode getChunkRenderMode() {
+    return renderMode;
+}
+
+const char* getChunkRenderModeName(ChunkRenderMode mode) {
+    if (mode < 0 || mode >= RENDER_MODE_COUNT) return "unknown";
+    return renderModeNames[mode];
+}
+
+static bool loadTileMap() {
+    if (cache->tileMap.id != 0) return true;
+    if (cache->tileMapFailed) return false;
+
+    cache->tileMapShader = LoadShaderFromMemory(NULL, tileMapFragmentShader);
+    int paletteLoc = GetShaderLocation(cache->tileMapShader, "palette");
+    if (paletteLoc < 0) {
+        // Compilation failed and raylib handed back its default shader
+        printf("Tile map shader unavailable, falling back to the atlas\n");
+        cache->tileMapFailed = true;
+        return false;
+    }
+
+    float palette[8][4] = {0};
+    for (int tile = 0; tile < 8; tile++) {
+        Vector4 color = ColorNormalize(getTileColor((TileType)tile));
+        palette[tile][0] = color.x;
+        palette[tile][1] = color.y;
+        palette[tile][2] = color.z;
+        palette[tile][3] = color.w;
+    }
+    SetShaderValueV(cache->tileMapShader, paletteLoc, palette, SHADER_UNIFORM_VEC4, 8);
+
+    Image image = {
+        .data = calloc(TILEMAP_WIDTH * TILEMAP_HEIGHT, 1),
+        .width = TILEMAP_WIDTH,
+        .height = TILEMAP_HEIGHT,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE,
+    };
+    cache->tileMap = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(cache->tileMap, TEXTURE_FILTER_POINT);
+    SetTextureWrap(cache->tileMap, TEXTURE_WRAP_REPEAT);
+
+    for (int x = 0; x < WORLD_WIDTH_CHUNKS; x++) {
+        for (int y = 0; y < TILEMAP_RING_ROWS; y++) cache->tileMapSlots[x][y].valid = false;
+    }
+    return true;
+}
+
+int pickChunkLod(float zoom) {
+    int lod = 0;
+    float cellPixels = TILE_SIZE * zoom;
+    while (lod < CHUNK_LOD_COUNT - 1 && cellPixels < LOD_MIN_CELL_PIXELS) {
+        cellPixels *= 2.0f;
+        lod++;
+    }
+    return lod;
+}
+
+void beginChunkRender(int startChunkX, int startChunkY, int endChunkX, int endChunkY, float zoom) {
+    cache->frame++;
+    visible = (VisibleRange){startChunkX, startChunkY, endChunkX, endChunkY};
+    frameLod = pickChunkLod(zoom);
+
+    if (renderMode == RENDER_MODE_TILEMAP_SHADER && !loadTileMap()) {
+        renderMode = RENDER_MODE_ATLAS;
+    }
+
+    if (renderMode == RENDER_MODE_ATLAS && cache->atlas.id == 0) {
+        Image image = GenImageColor(ATLAS_SIZE, ATLAS_SIZE, BLANK);
+        cache->atlas = LoadTextureFromImage(image);
+        UnloadImage(image);
+        SetTextureFilter(cache->atlas, TEXTURE_FILTER_POINT);
+    }
+
+    if (lightOverlay && cache->lightAtlas.id == 0) {
+        Image image = GenImageColor(ATLAS_SIZE, ATLAS_SIZE, BLANK);
+        cache->lightAtlas = LoadTextureFromImage(image);
+        UnloadImage(image);
+        SetTextureFilter(cache->lightAtlas, TEXTURE_FILTER_POINT);
+    }
+}
+
+static int ringRow(int chunkY) {
+    int row = chunkY % TILEMAP_RING_ROWS;
+    return (row < 0) ? row + TILEMAP_RING_ROWS : row;
+}
+
+void bindChunkRenderCache(ChunkRenderCache* newCache) {
+    cache = newCache;
+}
+
+void resetChunkRender(Chunk* chunk) {
+    chunk->render.atlasSlot = -1;
+    chunk->render.lightSlot = -1;
+    chunk->render.rectsValid = false;
+
+    // Tile map slots are found by position, and a new chunk's version
+    // starts over, so one left from an earlier chunk here could pass for
+    // current
+    if (!cache) return;
+    TileMapSlot* slot = &cache->tileMapSlots[chunk->x][ringRow(chunk->y)];
+    if (slot->chunkY == chunk->y) slot->valid = false;
+}
+
+void destroyChunkRender() {
+    if (!cache) return;
+
+    if (cache->atlas.id != 0) {
+        UnloadTexture(cache->atlas);
+        cache->atlas = (Texture2D){0};
+    }
+    for (int i = 0; i < ATLAS_SLOT_COUNT; i++) cache->slots[i].used = false;
+
+    if (cache->lightAtlas.id != 0) {
+        UnloadTexture(cache->lightAtlas);
+        cache->lightAtlas = (Texture2D){0};
+    }
+    for (int i = 0; i < ATLAS_SLOT_COUNT; i++) cache->lightSlots[i].used = false;
+
+    if (cache->tileMap.id != 0) {
+        UnloadTexture(cache->tileMap);
+        UnloadShader(cache->tileMapShader);
+        cache->tileMap = (Texture2D){0};
+    }
+}
+
+static Rectangle slotRect(int slot) {
+    return (Rectangle){
+        (float)((slot % ATLAS_SLOTS_PER_ROW) * CHUNK_SIZE),
+        (float)((slot / ATLAS_SLOTS_PER_ROW) * CHUNK_SIZE),
+        CHUNK_SIZE, CHUNK_SIZE
+    };
+}
+
+// Finds the chunk's slot among slots (the tile or the light atlas's), or
+// claims a free or least recently used one. Slots drawn this frame are
+// never evicted, since their quads may still be waiting in the batch.
+// Returns -1 when every slot is in use.
+static int acquireSlot(AtlasSlot* slots, int* chunkSlot, const Chunk* chunk, uint32_t version, bool* needsUpload) {
+    int slot = *chunkSlot;
+    if (slot >= 0 && slots[slot].used && slots[slot].chunkX == chunk->x && slots[slot].chunkY == chunk->y) {
+        *needsUpload = (slots[slot].version != version);
+        return slot;
+    }
+
+    int victim = -1;
+    for (int i = 0; i < ATLAS_SLOT_COUNT; i++) {
+        if (!slots[i].used) {
+            victim = i;
+            break;
+        }
+        if (slots[i].lastUsedFrame == cache->frame) continue;
+        if (victim < 0 || slots[i].lastUsedFrame < slots[victim].lastUsedFrame) victim = i;
+    }
+    if (victim < 0) return -1;
+
+    slots[victim] = (AtlasSlot){.chunkX = chunk->x, .chunkY = chunk->y, .used = true};
+    *chunkSlot = victim;
+    *needsUpload = true;
+    return victim;
+}
+
+static void uploadSlot(int slot, const Chunk* chunk) {
+    Color pixels[CHUNK_SIZE * CHUNK_SIZE];
+    bool empty = true;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            pixels[y * CHUNK_SIZE + x] = getTileColor(chunk->tiles[x][y]);
+            empty = empty && (chunk->tiles[x][y] == TILE_AIR);
+        }
+    }
+
+    if (!empty) UpdateTextureRec(cache->atlas, slotRect(slot), pixels);
+    cache->slots[slot].version = chunk->version;
+    cache->slots[slot].uploaded = true;
+    cache->slots[slot].empty = empty;
+}
+
+// Just the tiles changed since the slot's version, when the chunk can say
+// which. An empty slot was never written, so it takes the full upload.
+static void refreshSlot(int slot, const Chunk* chunk) {
+    AtlasSlot* atlasSlot = &cache->slots[slot];
+    int minX, minY, maxX, maxY;
+    if (!atlasSlot->uploaded || atlasSlot->empty ||
+        !getChunkChangesSince(chunk, atlasSlot->version, &minX, &minY, &maxX, &maxY)) {
+        uploadSlot(slot, chunk);
+        return;
+    }
+
+    Color pixels[CHUNK_SIZE * CHUNK_SIZE];
+    int width = maxX - minX + 1;
+    int height = maxY - minY + 1;
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) pixels[y * width + x] = getTileColor(chunk->tiles[minX + x][minY + y]);
+    }
+
+    Rectangle rect = slotRect(slot);
+    rect.x += minX;
+    rect.y += minY;
+    rect.width = width;
+    rect.height = height;
+    UpdateTextureRec(cache->atlas, rect, pixels);
+    atlasSlot->version = chunk->version;
+}
+
+// Greedy meshing: grow each unvisited tile right while the type matches,
+// then down while the whole span matches
+static void buildRenderRects(Chunk* chunk) {
+    bool visited[CHUNK_SIZE][CHUNK_SIZE] = {0};
+    ChunkRenderState* render = &chunk->render;
+    render->rectCount = 0;
+
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            TileType tile = chunk->tiles[x][y];
+            if (visited[x][y] || tile == TILE_AIR) continue;
+
+            int w = 1;
+            while (x + w < CHUNK_SIZE && !visited[x + w][y] && chunk->tiles[x + w][y] == tile) w++;
+
+            int h = 1;
+            while (y + h < CHUNK_SIZE) {
+                bool rowMatches = true;
+                for (int i = 0; i < w && rowMatches; i++) {
+                    rowMatches = !visited[x + i][y + h] && chunk->tiles[x + i][y + h] == tile;
+                }
+                if (!rowMatches) break;
+                h++;
+            }
+
+            for (int i = 0; i < w; i++) {
+                for (int j = 0; j < h; j++) visited[x + i][y + j] = true;
+            }
+            render->rects[render->rectCount++] = packRenderRect(x, y, w, h, tile);
+        }
+    }
+
+    render->rectsVersion = chunk->version;
+    render->rectsValid = true;
+}
+
+static void drawChunkRects(Chunk* chunk, int drawChunkX, int drawChunkY) {
+    ChunkRenderState* render = &chunk->render;
+    if (!render->rectsValid || render->rectsVersion != chunk->version) {
+        buildRenderRects(chunk);
+    }
+
+    int originX = drawChunkX * CHUNK_PIXEL_SIZE;
+    int originY = drawChunkY * CHUNK_PIXEL_SIZE;
+    for (int i = 0; i < render->rectCount; i++) {
+        uint32_t rect = render->rects[i];
+        int x = rect & 0xf;
+        int y = (rect >> 4) & 0xf;
+        int w = ((rect >> 8) & 0xf) + 1;
+        int h = ((rect >> 12) & 0xf) + 1;
+        DrawRectangle(originX + x * TILE_SIZE, originY + y * TILE_SIZE, w * TILE_SIZE, h * TILE_SIZE,
+                      getTileColor((TileType)(rect >> 16)));
+    }
+}
+
+static void drawChunkAtlas(Chunk* chunk, int drawChunkX, int drawChunkY) {
+    bool needsUpload = false;
+    int slot = acquireSlot(cache->slots, &chunk->render.atlasSlot, chunk, chunk->version, &needsUpload);
+    if (slot < 0) return;
+
+    if (needsUpload) refreshSlot(slot, chunk);
+    cache->slots[slot].lastUsedFrame = cache->frame;
+    if (cache->slots[slot].empty) return;
+
+    Rectangle dest = {
+        (float)(drawChunkX * CHUNK_PIXEL_SIZE),
+        (float)(drawChunkY * CHUNK_PIXEL_SIZE),
+        CHUNK_PIXEL_SIZE, CHUNK_PIXEL_SIZE
+    };
+    DrawTexturePro(cache->atlas, slotRect(slot), dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+// Darkness as alpha over the tiles, one texel per tile. A slot that is
+// fully lit everywhere draws nothing.
+static void uploadLightSlot(int slot, const Chunk* chunk) {
+    Color pixels[CHUNK_SIZE * CHUNK_SIZE];
+    bool empty = true;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            int level = getTileLight(chunk, x, y);
+            pixels[y * CHUNK_SIZE + x] = (Color){0, 0, 0, (unsigned char)((LIGHT_MAX - level) * 255 / LIGHT_MAX)};
+            empty = empty && level == LIGHT_MAX;
+        }
+    }
+
+    if (!empty) UpdateTextureRec(cache->lightAtlas, slotRect(slot), pixels);
+    cache->lightSlots[slot].version = chunk->light.version;
+    cache->lightSlots[slot].uploaded = true;
+    cache->lightSlots[slot].empty = empty;
+}
+
+void drawChunkLight(Chunk* chunk, int drawChunkX, int drawChunkY) {
+    // Summaries shade themselves (see drawChunkSummary)
+    if (!lightOverlay || !chunk->light.lit || frameLod > 0) return;
+
+    bool needsUpload = false;
+    int slot = acquireSlot(cache->lightSlots, &chunk->render.lightSlot, chunk, chunk->light.version, &needsUpload);
+    if (slot < 0) return;
+
+    if (needsUpload) uploadLightSlot(slot, chunk);
+    cache->lightSlots[slot].lastUsedFrame = cache->frame;
+    if (cache->lightSlots[slot].empty) return;
+
+    Rectangle dest = {
+        (float)(drawChunkX * CHUNK_PIXEL_SIZE),
+        (float)(drawChunkY * CHUNK_PIXEL_SIZE),
+        CHUNK_PIXEL_SIZE, CHUNK_PIXEL_SIZE
+    };
+    DrawTexturePro(cache->lightAtlas, slotRect(slot), dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+static void uploadTileMapSlot(int chunkX, int chunkY, const Chunk* chunk) {
+    unsigned char ids[CHUNK_SIZE * CHUNK_SIZE] = {0};
+    if (chunk) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) ids[y * CHUNK_SIZE + x] = (unsigned char)chunk->tiles[x][y];
+        }
+    }
+
+    Rectangle rect = {
+        (float)(chunkX * CHUNK_SIZE), (float)(ringRow(chunkY) * CHUNK_SIZE),
+        CHUNK_SIZE, CHUNK_SIZE
+    };
+    UpdateTextureRec(cache->tileMap, rect, ids);
+
+    TileMapSlot* slot = &cache->tileMapSlots[chunkX][ringRow(chunkY)];
+    slot->chunkY = chunkY;
+    slot->version = chunk ? chunk->version : 0;
+    slot->resident = (chunk != NULL);
+    slot->valid = true;
+}
+
+// The IDs changed since the slot's version, as in refreshSlot
+static void uploadTileMapChanges(TileMapSlot* slot, const Chunk* chunk, int minX, int minY, int maxX, int maxY) {
+    unsigned char ids[CHUNK_SIZE * CHUNK_SIZE];
+    int width = maxX - minX + 1;
+    int height = maxY - minY + 1;
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) ids[y * width + x] = (unsigned char)chunk->tiles[minX + x][minY + y];
+    }
+
+    Rectangle rect = {
+        (float)(chunk->x * CHUNK_SIZE + minX), (float)(ringRow(chunk->y) * CHUNK_SIZE + minY),
+        (float)width, (float)height
+    };
+    UpdateTextureRec(cache->tileMap, rect, ids);
+    slot->version = chunk->version;
+}
+
+// Only uploads; the whole region is drawn at once by endChunkRender
+static void updateTileMapChunk(Chunk* chunk) {
+    TileMapSlot* slot = &cache->tileMapSlots[chunk->x][ringRow(chunk->y)];
+    if (!slot->valid || !slot->resident || slot->chunkY != chunk->y) {
+        uploadTileMapSlot(chunk->x, chunk->y, chunk);
+    } else if (slot->version != chunk->version) {
+        int minX, minY, maxX, maxY;
+        if (getChunkChangesSince(chunk, slot->version, &minX, &minY, &maxX, &maxY)) {
+            uploadTileMapChanges(slot, chunk, minX, minY, maxX, maxY);
+        } else {
+            uploadTileMapSlot(chunk->x, chunk->y, chunk);
+        }
+    }
+    slot->lastUsedFrame = cache->frame;
+}
+
+static void drawTileMap() {
+    int chunksX = visible.endX - visible.startX + 1;
+    int chunksY = visible.endY - visible.startY + 1;
+    if (chunksX > WORLD_WIDTH_CHUNKS) chunksX = WORLD_WIDTH_CHUNKS;
+    if (chunksY > TILEMAP_RING_ROWS) chunksY = TILEMAP_RING_ROWS;
+
+    // Slots in view whose chunk isn't loaded still hold whatever was there
+    // before; clear them so the shader sees air
+    for (int cx = visible.startX; cx < visible.startX + chunksX; cx++) {
+        for (int cy = visible.startY; cy < visible.startY + chunksY; cy++) {
+            int wrappedX = wrapChunkX(cx);
+            TileMapSlot* slot = &cache->tileMapSlots[wrappedX][ringRow(cy)];
+            if (slot->lastUsedFrame == cache->frame) continue;
+            if (!slot->valid || slot->resident || slot->chunkY != cy) uploadTileMapSlot(wrappedX, cy, NULL);
+        }
+    }
+
+    // Texel (x, y) holds world tile (x, y mod TILEMAP_HEIGHT) and the texture
+    // repeats, so the source rectangle is simply the visible tile range
+    Rectangle source = {
+        (float)(visible.startX * CHUNK_SIZE), (float)(visible.startY * CHUNK_SIZE),
+        (float)(chunksX * CHUNK_SIZE), (float)(chunksY * CHUNK_SIZE)
+    };
+    Rectangle dest = {
+        (float)(visible.startX * CHUNK_PIXEL_SIZE), (float)(visible.startY * CHUNK_PIXEL_SIZE),
+        (float)(chunksX * CHUNK_PIXEL_SIZE), (float)(chunksY * CHUNK_PIXEL_SIZE)
+    };
+
+    BeginShaderMode(cache->tileMapShader);
+    DrawTexturePro(cache->tileMap, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+    EndShaderMode();
+}
+
+static Color getSummaryTileColor(uint8_t tile) {
+    return getTileColor((TileType)tile);
+}
+
+static Color getSummaryShade(uint8_t level) {
+    return (Color){0, 0, 0, (unsigned char)((LIGHT_MAX - level) * 255 / LIGHT_MAX)};
+}
+
+// Mean light of each summary cell, laid out like the tile summary and
+// rebuilt when the chunk's light changes
+static const uint8_t* getSummaryLight(Chunk* chunk, int lod) {
+    ChunkSummary* summary = &chunk->summary;
+    if (!summary->lightValid || summary->lightVersion != chunk->light.version) {
+        uint16_t sums[8 * 8] = {0};
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) sums[(x >> 1) * 8 + (y >> 1)] += (uint16_t)getTileLight(chunk, x, y);
+        }
+
+        int offset = 0, tiles = 4;
+        for (int level = 1; level < CHUNK_LOD_COUNT; level++) {
+            int size = CHUNK_SIZE >> level;
+            for (int i = 0; i < size * size; i++) summary->light[offset + i] = (uint8_t)((sums[i] + tiles / 2) / tiles);
+
+            // Fold 2x2 cells into the next level, in place like the tile summary
+            int next = size >> 1;
+            for (int x = 0; x < next; x++) {
+                for (int y = 0; y < next; y++) {
+                    sums[x * next + y] = sums[(2 * x) * size + 2 * y] + sums[(2 * x) * size + 2 * y + 1] +
+                                         sums[(2 * x + 1) * size + 2 * y] + sums[(2 * x + 1) * size + 2 * y + 1];
+                }
+            }
+            offset += size * size;
+            tiles *= 4;
+        }
+        summary->lightVersion = chunk->light.version;
+        summary->lightValid = true;
+    }
+
+    int offset = 0;
+    for (int level = 1; level < lod; level++) offset += (CHUNK_SIZE >> level) * (CHUNK_SIZE >> level);
+    return summary->light + offset;
+}
+
+// Summary cells are few, so they are greedily merged on the fly rather
+// than cached like the full-resolution rects. Cells equal to skip are
+// left undrawn.
+static void drawMergedCells(const uint8_t* cells, int size, uint8_t skip, int originX, int originY, int cellPixels,
+                            Color (*colorOf)(uint8_t)) {
+    bool visited[CHUNK_SIZE * CHUNK_SIZE / 4] = {0};
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            uint8_t value = cells[x * size + y];
+            if (visited[x * size + y] || value == skip) continue;
+
+            int w = 1;
+            while (x + w < size && !visited[(x + w) * size + y] && cells[(x + w) * size + y] == value) w++;
+
+            int h = 1;
+            while (y + h < size) {
+                bool rowMatches = true;
+                for (int i = 0; i < w && rowMatches; i++) {
+                    rowMatches = !visited[(x + i) * size + y + h] && cells[(x + i) * size + y + h] == value;
+                }
+                if (!rowMatches) break;
+                h++;
+            }
+
+            for (int i = 0; i < w; i++) {
+                for (int j = 0; j < h; j++) visited[(x + i) * size + y + j] = true;
+            }
+            DrawRectangle(originX + x * cellPixels, originY + y * cellPixels, w * cellPixels, h * cellPixels,
+                          colorOf(value));
+        }
+    }
+}
+
+// Zoomed out, a chunk is its summary, shaded per summary cell; there are
+// too many chunks on screen for per-tile light slots
+static void drawChunkSummary(Chunk* chunk, int drawChunkX, int drawChunkY) {
+    int size = CHUNK_SIZE >> frameLod;
+    int cellPixels = TILE_SIZE << frameLod;
+    int originX = drawChunkX * CHUNK_PIXEL_SIZE;
+    int originY = drawChunkY * CHUNK_PIXEL_SIZE;
+
+    drawMergedCells(getChunkSummary(chunk, frameLod), size, TILE_AIR, originX, originY, cellPixels,
+                    getSummaryTileColor);
+    if (lightOverlay && chunk->light.lit) {
+        drawMergedCells(getSummaryLight(chunk, frameLod), size, LIGHT_MAX, originX, originY, cellPixels,
+                        getSummaryShade);
+    }
+}
+
+void drawChunkTiles(Chunk* chunk, int drawChunkX, int drawChunkY) {
+    if (frameLod > 0) {
+        drawChunkSummary(chunk, drawChunkX, drawChunkY);
+        return;
+    }
+
+    switch (renderMode) {
+        case RENDER_MODE_ATLAS: drawChunkAtlas(chunk, drawChunkX, drawChunkY); break;
+        case RENDER_MODE_MERGED_RECTS: drawChunkRects(chunk, drawChunkX, drawChunkY); break;
+        case RENDER_MODE_TILEMAP_SHADER: updateTileMapChunk(chunk); break;
+        default: break;
+    }
+}
+
+void endChunkRender() {
+    if (frameLod == 0 && renderMode == RENDER_MODE_TILEMAP_SHADER) drawTileMap();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <raylib.h>
+#include "chunk.h"
+
+// Chunk rendering, in one of these modes:
+//
+// Atlas: every chunk is rasterized once into a 16x16 slot of a shared atlas
+// texture, one texel per tile, and drawn as a single point-filtered quad
+// scaled up to CHUNK_PIXEL_SIZE. A slot is re-uploaded only when its
+// chunk's version changes, and only the edited rectangle when the chunk
+// says what changed since (see getChunkChangesSince); when the atlas is
+// full the least recently drawn slot is evicted.
+//
+// Merged rects: no textures. Runs of identical tiles are greedily merged
+// into rectangles once per chunk version, and the list is replayed with
+// DrawRectangle every frame.
+//
+// Tile map shader: tile IDs live in an R8 texture, one texel per tile,
+// covering the whole world width and TILEMAP_RING_ROWS chunk rows that
+// wrap vertically. Changed chunks upload their 16x16 IDs (or just the
+// edited rectangle, as in the atlas), and the whole visible region draws
+// as one quad whose fragment shader maps IDs to colors, so per-frame CPU
+// cost doesn't depend on tile count or zoom.
+
+typedef enum ChunkRenderMode
+{
+    RENDER_MODE_ATLAS,
+    RENDER_MODE_MERGED_RECTS,
+    RENDER_MODE_TILEMAP_SHADER,
+    RENDER_MODE_COUNT
+} ChunkRenderMode;
+
+// Zoomed out, chunks draw from their summaries instead (see
+// getChunkSummary) at the finest LOD whose cells still cover this many
+// screen pixels. Keeping cells as large as a tile at zoom 1, rather than
+// a single pixel, bounds the cells on screen by the default view's tile
+// count at every zoom level.
+#define LOD_MIN_CELL_PIXELS TILE_SIZE
+
+#define TILEMAP_RING_ROWS 32
+#define TILEMAP_WIDTH (WORLD_WIDTH_CHUNKS * CHUNK_SIZE)
+#define TILEMAP_HEIGHT (TILEMAP_RING_ROWS * CHUNK_SIZE)
+
+#define ATLAS_SLOTS_PER_ROW 32
+#define ATLAS_SLOT_COUNT (ATLAS_SLOTS_PER_ROW * ATLAS_SLOTS_PER_ROW) // Texture budget, in chunks
+#define ATLAS_SIZE (ATLAS_SLOTS_PER_ROW * CHUNK_SIZE)
+
+typedef struct AtlasSlot
+{
+    int chunkX, chunkY;
+    uint32_t version;
+    unsigned int lastUsedFrame;
+    bool used;
+    bool uploaded; // Holds the chunk as of version
+    bool empty; // All air, nothing to draw
+} AtlasSlot;
+
+// What a tile map texture slot currently holds
+typedef struct TileMapSlot
+{
+    int chunkY;
+    uint32_t version;
+    unsigned int lastUsedFrame;
+    bool valid;
+    bool resident; // False when it was cleared for a chunk that isn't loaded
+} TileMapSlot;
+
+// GPU handles and what they hold, allocated once from the host's arena.
+// raylib and its GL context belong to the host, so after a hot reload the
+// textures are still there and nothing is uploaded twice.
+typedef struct ChunkRenderCache
+{
+    Texture2D atlas;
+    AtlasSlot slots[ATLAS_SLOT_COUNT];
+
+    Texture2D lightAtlas; // Laid out like atlas, with its own slots
+    AtlasSlot lightSlots[ATLAS_SLOT_COUNT];
+
+    Texture2D tileMap;
+    Shader tileMapShader;
+    bool tileMapFailed;
+    TileMapSlot tileMapSlots[WORLD_WIDTH_CHUNKS][TILEMAP_RING_ROWS];
+
+    unsigned int frame;
+} ChunkRenderCache;
+
+void bindChunkRenderCache(ChunkRenderCache* cache);
+
+// Call when a pool node starts holding a new chunk, with its coordinates
+// set: forgets what the caches hold for whatever was there before
+void resetChunkRender(Chunk* chunk);
+
+Color getTileColor(TileType tile);
+
+void setChunkRenderMode(ChunkRenderMode mode);
+ChunkRenderMode getChunkRenderMode();
+const char* getChunkRenderModeName(ChunkRenderMode mode);
+
+// Lighting (see light.h) darkens the tiles through a second atlas of the
+// same layout, holding each tile's darkness as alpha. Slots follow the
+// chunk's light version rather than its tile version. On by default.
+void setChunkLightOverlay(bool enabled);
+
+// LOD used at a camera zoom, 0 being full tiles
+int pickChunkLod(float zoom);
+
+// Call once per frame before drawing chunks, with the visible chunk range
+// (unwrapped, inclusive) and the camera zoom
+void beginChunkRender(int startChunkX, int startChunkY, int endChunkX, int endChunkY, float zoom);
+
+// Draws a generated chunk with its top-left corner at chunk coordinates
+// (drawChunkX, drawChunkY), which may be unwrapped
+void drawChunkTiles(Chunk* chunk, int drawChunkX, int drawChunkY);
+
+// Call inside the camera's 2D mode after the visible chunks were drawn
+void endChunkRender();
+
+// Shades a chunk drawn with drawChunkTiles; call after endChunkRender, so
+// it also covers what the tile map drew there
+void drawChunkLight(Chunk* chunk, int drawChunkX, int drawChunkY);
+
+void destroyChunkRender();
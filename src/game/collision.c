@@ -0,0 +1,84 @@
+#include "collision.h"
+#include "occupancy.h"
+#include <math.h>
+
+// Gap left between a box and the wall it stopped at, so rounding never
+// puts the box inside the wall on the next move
+#define COLLISION_SKIN 0.01f
+
+// Tiles covered by [min, max): the last one is the tile max reaches into
+static inline int firstTile(float min) {
+    return (int)floorf(min / TILE_SIZE);
+}
+
+static inline int lastTile(float max) {
+    return (int)ceilf(max / TILE_SIZE) - 1;
+}
+
+bool boxOverlapsSolid(Vector2 center, Vector2 halfSize) {
+    return isSolidInRect(firstTile(center.x - halfSize.x), firstTile(center.y - halfSize.y),
+                         lastTile(center.x + halfSize.x), lastTile(center.y + halfSize.y));
+}
+
+// Distance left before an edge at `edge` moving by delta reaches `wall`,
+// never backwards
+static inline float stopBefore(float edge, float wall, float delta) {
+    return (delta > 0) ? fmaxf(wall - edge - COLLISION_SKIN, 0.0f) : fminf(wall - edge + COLLISION_SKIN, 0.0f);
+}
+
+// Distance the box can move along X before touching a solid column
+static float sweepX(Vector2 center, Vector2 halfSize, float dx, bool* hit) {
+    float minX = center.x - halfSize.x;
+    float maxX = center.x + halfSize.x;
+    int firstRow = firstTile(center.y - halfSize.y);
+    int lastRow = lastTile(center.y + halfSize.y);
+
+    // Columns the leading edge sweeps, nearest first
+    int from = (dx > 0) ? firstTile(maxX) : lastTile(minX);
+    int to = (dx > 0) ? lastTile(maxX + dx) : firstTile(minX + dx);
+    if ((dx > 0) ? to < from : to > from) return dx;
+
+    int nearest = to;
+    for (int row = firstRow; row <= lastRow; row++) {
+        int column;
+        if (!findSolidInRow(row, from, nearest, &column)) continue;
+        nearest = column;
+        *hit = true;
+        if (nearest == from) break;
+    }
+    if (!*hit) return dx;
+    return (dx > 0) ? stopBefore(maxX, nearest * TILE_SIZE, dx) : stopBefore(minX, (nearest + 1) * TILE_SIZE, dx);
+}
+
+// Same along Y, one row of the box's columns at a time
+static float sweepY(Vector2 center, Vector2 halfSize, float dy, bool* hit) {
+    float minY = center.y - halfSize.y;
+    float maxY = center.y + halfSize.y;
+    int firstColumn = firstTile(center.x - halfSize.x);
+    int lastColumn = lastTile(center.x + halfSize.x);
+
+    int step = (dy > 0) ? 1 : -1;
+    int from = (dy > 0) ? firstTile(maxY) : lastTile(minY);
+    int to = (dy > 0) ? lastTile(maxY + dy) : firstTile(minY + dy);
+
+    *hit = false;
+    for (int row = from; (dy > 0) ? row <= to : row >= to; row += step) {
+        if (!isSolidInRect(firstColumn, row, lastColumn, row)) continue;
+        *hit = true;
+        return (dy > 0) ? stopBefore(maxY, row * TILE_SIZE, dy) : stopBefore(minY, (row + 1) * TILE_SIZE, dy);
+    }
+    return dy;
+}
+
+SweepResult sweepBox(Vector2 center, Vector2 halfSize, Vector2 delta) {
+    SweepResult result = {center, false, false};
+    if (boxOverlapsSolid(center, halfSize)) {
+        result.center.x += delta.x;
+        result.center.y += delta.y;
+        return result;
+    }
+
+    if (delta.x != 0.0f) result.center.x += sweepX(result.center, halfSize, delta.x, &result.hitX);
+    if (delta.y != 0.0f) result.center.y += sweepY(result.center, halfSize, delta.y, &result.hitY);
+    return result;
+}
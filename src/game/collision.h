@@ -0,0 +1,27 @@
+#pragma once
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// Axis-aligned boxes moving through the tile world. A move is swept one
+// axis at a time: the tiles the leading edge passes over are checked with
+// the occupancy masks (a row scan or a one-row rectangle test per tile
+// line), and the box stops flush against the nearest solid tile, so no
+// speed can tunnel through a wall.
+//
+// Positions are world pixels and may be unwrapped; tile queries wrap X,
+// so a box straddling the world seam collides with both sides of it. A
+// box that already overlaps solid tiles (say a chunk generated around it)
+// moves freely until it is out.
+
+typedef struct SweepResult
+{
+    Vector2 center; // Where the box ended up, unwrapped
+    bool hitX, hitY; // Stopped short on that axis
+} SweepResult;
+
+// Moves a box of the given half size centered at center by delta
+SweepResult sweepBox(Vector2 center, Vector2 halfSize, Vector2 delta);
+
+// True if the box covers any solid tile
+bool boxOverlapsSolid(Vector2 center, Vector2 halfSize);
@@ -0,0 +1,194 @@
+#include "decoration.h"
+#include "world_gen.h"
+#include "occupancy.h"
+#include "light.h"
+#include <string.h>
+
+// 1 in N ceiling/floor tiles grows a stalactite/stalagmite
+#define STALACTITE_CHANCE 8
+#define STALAGMITE_CHANCE 10
+#define STALACTITE_MAX_LENGTH 4
+#define STALAGMITE_MAX_LENGTH 3
+
+static DecorationState* decorations = NULL;
+
+static unsigned int hashPendingCoord(int x, int y) {
+    return (((unsigned int)x * 73856093) ^ ((unsigned int)y * 19349663)) % CHUNK_MAP_SIZE;
+}
+
+// Deterministic per-tile random value from the world seed
+static uint32_t tileRandom(uint32_t seed, int worldX, int worldY) {
+    uint32_t h = seed ^ ((uint32_t)worldX * 0x8da6b343u) ^ ((uint32_t)worldY * 0xd8163841u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+void initDecorations(DecorationState* state) {
+    memset(state->buckets, 0, sizeof(state->buckets));
+    state->freeList = NULL;
+    state->poolUsed = 0;
+    state->stats = (DecorationStats){0};
+    decorations = state;
+}
+
+void bindDecorations(DecorationState* state) {
+    decorations = state;
+}
+
+static PendingRuns* findPending(int chunkX, int chunkY, bool create) {
+    unsigned int hash = hashPendingCoord(chunkX, chunkY);
+    for (PendingRuns* pending = decorations->buckets[hash]; pending; pending = pending->next) {
+        if (pending->x == chunkX && pending->y == chunkY) return pending;
+    }
+    if (!create) return NULL;
+
+    PendingRuns* pending = decorations->freeList;
+    if (pending) {
+        decorations->freeList = pending->next;
+    } else if (decorations->poolUsed < DECORATION_PENDING_CAPACITY) {
+        pending = &decorations->pool[decorations->poolUsed++];
+    } else {
+        return NULL;
+    }
+    decorations->stats.pendingChunks++;
+    pending->x = chunkX;
+    pending->y = chunkY;
+    pending->count = 0;
+    pending->next = decorations->buckets[hash];
+    decorations->buckets[hash] = pending;
+    return pending;
+}
+
+// Returns the number of tiles placed
+static int applyRun(Chunk* chunk, DecorationRun run) {
+    int y = run.y;
+    int placed = 0;
+    while (placed < run.length && y >= 0 && y < CHUNK_SIZE) {
+        if (chunk->tiles[run.x][y] != (TileType)run.replace) break;
+        chunk->tiles[run.x][y] = (TileType)run.type;
+        updateSolidCell(chunk, run.x, y);
+        placed++;
+        y += run.dy;
+    }
+    return placed;
+}
+
+static void queueRun(int chunkX, int chunkY, DecorationRun run) {
+    chunkX = wrapChunkX(chunkX);
+    PendingRuns* pending = findPending(chunkX, chunkY, true);
+    if (!pending) {
+        decorations->stats.droppedRuns++;
+        return;
+    }
+
+    // A source chunk that regenerates emits the same runs again
+    for (int i = 0; i < pending->count; i++) {
+        if (memcmp(&pending->runs[i], &run, sizeof(run)) == 0) return;
+    }
+
+    if (pending->count == DECORATION_MAX_PENDING_RUNS) {
+        decorations->stats.droppedRuns++;
+        return;
+    }
+    pending->runs[pending->count++] = run;
+    decorations->stats.queuedRuns++;
+
+    Chunk* target = getChunk(chunkX, chunkY);
+    if (target && target->generated && applyRun(target, run) > 0) {
+        markChunkChanged(target);
+        lightChunk(target);
+    }
+}
+
+// Places a run starting inside `chunk`; whatever is left when it reaches
+// the top or bottom border continues in the neighbour
+static void placeRun(Chunk* chunk, DecorationRun run) {
+    int placed = applyRun(chunk, run);
+    int endY = run.y + placed * run.dy;
+    if (placed == run.length || (endY >= 0 && endY < CHUNK_SIZE)) return;
+
+    DecorationRun rest = run;
+    rest.length = (uint8_t)(run.length - placed);
+    rest.y = (run.dy > 0) ? 0 : CHUNK_SIZE - 1;
+    queueRun(chunk->x, chunk->y + run.dy, rest);
+}
+
+void decorateChunk(Chunk* chunk) {
+    uint32_t seed = getWorldGenLayerSeed(WORLD_GEN_LAYER_DECORATION);
+    int worldStartX = chunk->x * CHUNK_SIZE;
+    int worldStartY = chunk->y * CHUNK_SIZE;
+
+    // Decide everything from the undecorated terrain first, so a new
+    // stalactite can't become the ceiling of another
+    DecorationRun runs[CHUNK_SIZE * CHUNK_SIZE];
+    int runCount = 0;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 1; y < CHUNK_SIZE - 1; y++) {
+            if (chunk->tiles[x][y] != TILE_AIR) continue;
+
+            uint32_t r = tileRandom(seed, worldStartX + x, worldStartY + y);
+
+            // Cave ceiling: rock above, air below
+            if (chunk->tiles[x][y - 1] == TILE_ROCK && chunk->tiles[x][y + 1] == TILE_AIR &&
+                r % STALACTITE_CHANCE == 0) {
+                runs[runCount++] = (DecorationRun){
+                    .x = x, .y = y, .dy = 1,
+                    .length = 1 + (r >> 8) % STALACTITE_MAX_LENGTH,
+                    .type = TILE_ROCK, .replace = TILE_AIR,
+                };
+            }
+            // Cave floor: air above, rock below
+            else if (chunk->tiles[x][y - 1] == TILE_AIR && chunk->tiles[x][y + 1] == TILE_ROCK &&
+                     (r >> 4) % STALAGMITE_CHANCE == 0) {
+                runs[runCount++] = (DecorationRun){
+                    .x = x, .y = y, .dy = -1,
+                    .length = 1 + (r >> 8) % STALAGMITE_MAX_LENGTH,
+                    .type = TILE_ROCK, .replace = TILE_AIR,
+                };
+            }
+        }
+    }
+
+    for (int i = 0; i < runCount; i++) {
+        placeRun(chunk, runs[i]);
+    }
+
+    // Then whatever neighbours queued for this chunk
+    PendingRuns* pending = findPending(chunk->x, chunk->y, false);
+    if (pending) {
+        for (int i = 0; i < pending->count; i++) {
+            applyRun(chunk, pending->runs[i]);
+        }
+    }
+}
+
+// Kept while its chunk is loaded, so a source that regenerates doesn't
+// apply the runs twice, or while a source is, since that one won't emit
+// its runs again until it regenerates
+static void releaseIfUnneeded(int chunkX, int chunkY) {
+    if (getChunk(chunkX, chunkY) || getChunk(chunkX, chunkY - 1) || getChunk(chunkX, chunkY + 1)) return;
+    PendingRuns* pending = findPending(chunkX, chunkY, false);
+    if (!pending) return;
+
+    PendingRuns** link = &decorations->buckets[hashPendingCoord(chunkX, chunkY)];
+    while (*link != pending) link = &(*link)->next;
+    *link = pending->next;
+    pending->next = decorations->freeList;
+    decorations->freeList = pending;
+    decorations->stats.pendingChunks--;
+}
+
+void releaseChunkDecorations(int chunkX, int chunkY) {
+    if (!decorations) return;
+    chunkX = wrapChunkX(chunkX);
+    for (int dy = -1; dy <= 1; dy++) releaseIfUnneeded(chunkX, chunkY + dy);
+}
+
+DecorationStats getDecorationStats() {
+    return decorations->stats;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include "chunk.h"
+
+// Decoration stage run after a chunk's terrain is generated. Structures
+// (stalactites, stalagmites) are decided from the chunk's own terrain and
+// may extend across its border. The part landing in a neighbour becomes a
+// run in that neighbour's pending queue and is applied when it loads, or
+// straight away if it is already loaded.
+//
+// Runs stay queued after they are applied, so a neighbour that is
+// unloaded and later regenerated gets them again, and a source that
+// regenerates doesn't apply them twice. A queue is freed once neither its
+// chunk nor either chunk that feeds it is loaded: a source emits its runs
+// again when it next generates, so nothing is lost. Already-loaded chunks
+// are only ever written to, never regenerated.
+
+// A vertical run of tiles: starting at (x, y) and stepping by dy, place
+// `type` over up to `length` tiles, stopping at the first tile that is
+// not `replace`
+typedef struct DecorationRun
+{
+    uint8_t x, y;
+    int8_t dy;
+    uint8_t length;
+    uint8_t type;
+    uint8_t replace;
+} DecorationRun;
+
+// A chunk receives at most one crossing run per column from each vertical
+// neighbour
+#define DECORATION_MAX_PENDING_RUNS (2 * CHUNK_SIZE)
+
+// Bounds how many chunks can have queues at once; past it, new
+// cross-border runs are dropped
+#define DECORATION_PENDING_CAPACITY 16384
+
+typedef struct PendingRuns
+{
+    int x, y; // Target chunk coordinates
+    DecorationRun runs[DECORATION_MAX_PENDING_RUNS];
+    int count;
+    struct PendingRuns* next;
+} PendingRuns;
+
+typedef struct DecorationStats
+{
+    uint64_t queuedRuns;  // Cross-border runs queued, lifetime
+    uint64_t droppedRuns; // Runs that found no room, lifetime
+    int pendingChunks;    // Queues in use
+} DecorationStats;
+
+// Pending queues, allocated once from the host's arena
+typedef struct DecorationState
+{
+    PendingRuns* buckets[CHUNK_MAP_SIZE];
+    PendingRuns* freeList; // Freed queues, reused before the rest of the pool
+    int poolUsed;
+    DecorationStats stats;
+    PendingRuns pool[DECORATION_PENDING_CAPACITY];
+} DecorationState;
+
+void initDecorations(DecorationState* state);
+void bindDecorations(DecorationState* state);
+
+// Places the chunk's own decorations, then the runs neighbours queued for it
+void decorateChunk(Chunk* chunk);
+
+// Call after a chunk is unloaded: frees the queues of it and its vertical
+// neighbours that nothing loaded needs any more
+void releaseChunkDecorations(int chunkX, int chunkY);
+
+DecorationStats getDecorationStats();
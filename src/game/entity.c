@@ -0,0 +1,468 @@
+#include "entity.h"
+#include "collision.h"
+#include <math.h>
+#include <string.h>
+
+static EntityState* entities = NULL;
+
+#define SLOT_BITS 16
+#define SLOT_MASK ((1u << SLOT_BITS) - 1)
+#define CELL_MASK (ENTITY_CELL_CAPACITY - 1)
+
+static const Color typeColors[ENTITY_TYPE_COUNT] = {MAROON, YELLOW, SKYBLUE};
+
+void initEntities(EntityState* state) {
+    entities = state;
+    state->count = 0;
+    state->activeCount = 0;
+    memset(&state->stats, 0, sizeof(state->stats));
+
+    state->freeSlotCount = ENTITY_CAPACITY;
+    for (int i = 0; i < ENTITY_CAPACITY; i++) {
+        state->slotIndex[i] = -1;
+        state->slotGeneration[i] = 0;
+        state->freeSlots[i] = (uint16_t)(ENTITY_CAPACITY - 1 - i); // Low slots first
+    }
+    for (int i = 0; i < ENTITY_CELL_CAPACITY; i++) state->cellTable[i].first = -1;
+}
+
+void bindEntities(EntityState* state) {
+    entities = state;
+}
+
+// --- Cells ---
+
+static inline unsigned int hashCell(int chunkX, int chunkY) {
+    return (((unsigned int)chunkX * 73856093) ^ ((unsigned int)chunkY * 19349663)) & CELL_MASK;
+}
+
+static inline bool isChunkResident(int chunkX, int chunkY) {
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    return chunk && chunk->generated;
+}
+
+static inline int getEntityChunkX(Vector2 position) {
+    return wrapChunkX((int)floorf(position.x / CHUNK_PIXEL_SIZE));
+}
+
+static inline int getEntityChunkY(Vector2 position) {
+    return (int)floorf(position.y / CHUNK_PIXEL_SIZE);
+}
+
+// Table index of the cell for a chunk (X wrapped), or -1. With create, an
+// absent cell is added, parked if its chunk isn't loaded, for the caller
+// to link an entity into straight away; -1 then means the table is full.
+static int findCell(int chunkX, int chunkY, bool create) {
+    unsigned int slot = hashCell(chunkX, chunkY);
+    for (int probe = 0; probe < ENTITY_CELL_CAPACITY; probe++) {
+        EntityCell* cell = &entities->cellTable[slot];
+        if (cell->first < 0) {
+            if (!create) return -1;
+            *cell = (EntityCell){chunkX, chunkY, -1, 0, !isChunkResident(chunkX, chunkY)};
+            return (int)slot;
+        }
+        if (cell->chunkX == chunkX && cell->chunkY == chunkY) return (int)slot;
+        slot = (slot + 1) & CELL_MASK;
+    }
+    return -1;
+}
+
+// Takes an emptied cell out of the table, shifting later cells of its
+// probe run back so lookups never stop early. Cells in the table always
+// hold an entity, so an empty list marks a free slot.
+static void removeCell(int hole) {
+    int index = hole;
+    for (;;) {
+        index = (index + 1) & CELL_MASK;
+        EntityCell* cell = &entities->cellTable[index];
+        if (cell->first < 0) return;
+
+        int home = (int)hashCell(cell->chunkX, cell->chunkY);
+        bool movable = (index > hole) ? (home <= hole || home > index) : (home <= hole && home > index);
+        if (!movable) continue;
+
+        entities->cellTable[hole] = *cell;
+        for (int i = cell->first; i >= 0; i = entities->cellNext[i]) entities->cells[i] = hole;
+        cell->first = -1;
+        hole = index;
+    }
+}
+
+// --- Dense arrays ---
+
+static void linkEntity(int index, int cellIndex) {
+    EntityCell* cell = &entities->cellTable[cellIndex];
+    entities->cells[index] = cellIndex;
+    entities->cellPrev[index] = -1;
+    entities->cellNext[index] = cell->first;
+    if (cell->first >= 0) entities->cellPrev[cell->first] = index;
+    cell->first = index;
+    cell->count++;
+}
+
+// Leaves the cell in the table even if it is now empty; callers remove it
+// once nothing refers to its index any more
+static void unlinkEntity(int index) {
+    EntityCell* cell = &entities->cellTable[entities->cells[index]];
+    int prev = entities->cellPrev[index], next = entities->cellNext[index];
+    if (prev >= 0) entities->cellNext[prev] = next;
+    else cell->first = next;
+    if (next >= 0) entities->cellPrev[next] = prev;
+    cell->count--;
+}
+
+#define SWAP_FIELD(field, type) \
+    do { \
+        type swapped = entities->field[a]; \
+        entities->field[a] = entities->field[b]; \
+        entities->field[b] = swapped; \
+    } while (0)
+
+// Exchanges two entities' places in the dense arrays; cells stay put
+static void swapEntities(int a, int b) {
+    if (a == b) return;
+    int cellA = entities->cells[a], cellB = entities->cells[b];
+    unlinkEntity(a);
+    unlinkEntity(b);
+    SWAP_FIELD(positions, Vector2);
+    SWAP_FIELD(prevPositions, Vector2);
+    SWAP_FIELD(velocities, Vector2);
+    SWAP_FIELD(halfSizes, Vector2);
+    SWAP_FIELD(types, uint8_t);
+    SWAP_FIELD(ids, EntityId);
+    entities->slotIndex[entities->ids[a] & SLOT_MASK] = a;
+    entities->slotIndex[entities->ids[b] & SLOT_MASK] = b;
+    linkEntity(a, cellB);
+    linkEntity(b, cellA);
+}
+
+// Parking and waking move an entity across the active/parked boundary
+static void parkEntity(int index) {
+    swapEntities(index, entities->activeCount - 1);
+    entities->activeCount--;
+    entities->stats.parked++;
+}
+
+static void wakeEntity(int index) {
+    swapEntities(index, entities->activeCount);
+    entities->activeCount++;
+    entities->stats.woken++;
+}
+
+// Removes the entity at index, keeping both parts of the arrays dense
+static void removeEntity(int index) {
+    // Walk it to the end: the last active entity takes its place, and the
+    // last parked one the place that leaves
+    if (index < entities->activeCount) {
+        swapEntities(index, entities->activeCount - 1);
+        index = --entities->activeCount;
+    }
+    swapEntities(index, entities->count - 1);
+    index = --entities->count;
+
+    uint16_t slot = (uint16_t)(entities->ids[index] & SLOT_MASK);
+    entities->slotIndex[slot] = -1;
+    entities->freeSlots[entities->freeSlotCount++] = slot;
+    int cell = entities->cells[index];
+    unlinkEntity(index);
+    if (entities->cellTable[cell].count == 0) removeCell(cell);
+}
+
+EntityId spawnEntity(EntityType type, Vector2 position, Vector2 velocity, Vector2 halfSize) {
+    if (entities->count == ENTITY_CAPACITY) return 0;
+    position.x = wrapWorldX(position.x);
+    int cell = findCell(getEntityChunkX(position), getEntityChunkY(position), true);
+    if (cell < 0) return 0;
+
+    uint16_t slot = entities->freeSlots[--entities->freeSlotCount];
+    uint16_t generation = ++entities->slotGeneration[slot];
+    if (generation == 0) generation = entities->slotGeneration[slot] = 1;
+    EntityId id = ((EntityId)generation << SLOT_BITS) | slot;
+
+    int index = entities->count++;
+    entities->positions[index] = position;
+    entities->prevPositions[index] = position;
+    entities->velocities[index] = velocity;
+    entities->halfSizes[index] = (Vector2){fminf(halfSize.x, ENTITY_MAX_HALF_SIZE), fminf(halfSize.y, ENTITY_MAX_HALF_SIZE)};
+    entities->types[index] = (uint8_t)type;
+    entities->ids[index] = id;
+    entities->slotIndex[slot] = index;
+    linkEntity(index, cell);
+
+    // New entities start parked at the end; wake it unless its chunk isn't loaded
+    if (!entities->cellTable[cell].parked) wakeEntity(index);
+    return id;
+}
+
+int getEntityIndex(EntityId id) {
+    int slot = (int)(id & SLOT_MASK);
+    if (id == 0 || slot >= ENTITY_CAPACITY || entities->slotIndex[slot] < 0) return -1;
+    int index = entities->slotIndex[slot];
+    return (entities->ids[index] == id) ? index : -1;
+}
+
+bool despawnEntity(EntityId id) {
+    int index = getEntityIndex(id);
+    if (index < 0) return false;
+    removeEntity(index);
+    return true;
+}
+
+// --- Updates ---
+
+// Parks the entities of cells whose chunk was unloaded, wakes those whose
+// chunk is back
+static void syncParkedCells() {
+    static EntityId members[ENTITY_CAPACITY];
+    if (entities->count == 0) return;
+    for (int c = 0; c < ENTITY_CELL_CAPACITY; c++) {
+        EntityCell* cell = &entities->cellTable[c];
+        if (cell->first < 0) continue;
+        bool parked = !isChunkResident(cell->chunkX, cell->chunkY);
+        if (parked == cell->parked) continue;
+
+        // Ids, as each swap moves others around the dense arrays
+        int count = 0;
+        for (int i = cell->first; i >= 0; i = entities->cellNext[i]) members[count++] = entities->ids[i];
+        for (int i = 0; i < count; i++) {
+            int index = entities->slotIndex[members[i] & SLOT_MASK];
+            if (parked) parkEntity(index);
+            else wakeEntity(index);
+        }
+        cell->parked = parked;
+    }
+}
+
+// Moves an entity into the cell for its new position. False, with the
+// entity left where it was, if the cell table is full.
+static bool rebucketEntity(int index) {
+    Vector2 position = entities->positions[index];
+    int oldCell = entities->cells[index];
+    int chunkX = getEntityChunkX(position), chunkY = getEntityChunkY(position);
+    if (entities->cellTable[oldCell].chunkX == chunkX && entities->cellTable[oldCell].chunkY == chunkY) return true;
+
+    int newCell = findCell(chunkX, chunkY, true);
+    if (newCell < 0) return false;
+    unlinkEntity(index);
+    linkEntity(index, newCell);
+    if (entities->cellTable[oldCell].count == 0) removeCell(oldCell);
+    entities->stats.rebucketed++;
+    return true;
+}
+
+void updateEntities(float dt) {
+    syncParkedCells();
+
+    // Entities swapped into index i from further on haven't been updated
+    // yet, so i only advances past entities that stay active
+    for (int i = 0; i < entities->activeCount;) {
+        Vector2 start = entities->positions[i];
+        Vector2 velocity = entities->velocities[i];
+        Vector2 delta = {velocity.x * dt, velocity.y * dt};
+        SweepResult sweep = sweepBox(start, entities->halfSizes[i], delta);
+        entities->stats.updated++;
+
+        if ((sweep.hitX || sweep.hitY) && entities->types[i] == ENTITY_PROJECTILE) {
+            removeEntity(i);
+            continue;
+        }
+        if (sweep.hitX) entities->velocities[i].x = 0.0f;
+        if (sweep.hitY) entities->velocities[i].y = 0.0f;
+
+        // Wrap, keeping the previous position on the same side of the seam
+        Vector2 previous = start;
+        Vector2 position = sweep.center;
+        position.x = wrapWorldX(position.x);
+        if (position.x - previous.x > WORLD_WIDTH_PIXELS / 2) previous.x += WORLD_WIDTH_PIXELS;
+        else if (previous.x - position.x > WORLD_WIDTH_PIXELS / 2) previous.x -= WORLD_WIDTH_PIXELS;
+        entities->prevPositions[i] = previous;
+        entities->positions[i] = position;
+
+        if (!rebucketEntity(i)) {
+            entities->positions[i] = entities->prevPositions[i] = start;
+            entities->velocities[i] = (Vector2){0.0f, 0.0f};
+        } else if (entities->cellTable[entities->cells[i]].parked) {
+            parkEntity(i);
+            continue;
+        }
+        i++;
+    }
+}
+
+// --- Queries ---
+
+// X distance from a to b, the short way around the world
+static inline float wrapDeltaX(float a, float b) {
+    float dx = b - a;
+    if (dx > WORLD_WIDTH_PIXELS / 2) dx -= WORLD_WIDTH_PIXELS;
+    else if (dx < -WORLD_WIDTH_PIXELS / 2) dx += WORLD_WIDTH_PIXELS;
+    return dx;
+}
+
+int queryEntities(Vector2 center, float radius, int* indices, int maxCount) {
+    float reach = radius + ENTITY_MAX_HALF_SIZE;
+    int minChunkX = (int)floorf((center.x - reach) / CHUNK_PIXEL_SIZE);
+    int maxChunkX = (int)floorf((center.x + reach) / CHUNK_PIXEL_SIZE);
+    int minChunkY = (int)floorf((center.y - reach) / CHUNK_PIXEL_SIZE);
+    int maxChunkY = (int)floorf((center.y + reach) / CHUNK_PIXEL_SIZE);
+    if (maxChunkX - minChunkX >= WORLD_WIDTH_CHUNKS) maxChunkX = minChunkX + WORLD_WIDTH_CHUNKS - 1;
+
+    int found = 0;
+    for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+        for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+            int c = findCell(wrapChunkX(chunkX), chunkY, false);
+            if (c < 0 || entities->cellTable[c].parked) continue;
+
+            for (int i = entities->cellTable[c].first; i >= 0; i = entities->cellNext[i]) {
+                // Distance from the center to the nearest point of the box
+                Vector2 half = entities->halfSizes[i];
+                float dx = fmaxf(fabsf(wrapDeltaX(center.x, entities->positions[i].x)) - half.x, 0.0f);
+                float dy = fmaxf(fabsf(entities->positions[i].y - center.y) - half.y, 0.0f);
+                if (dx * dx + dy * dy > radius * radius) continue;
+                if (found < maxCount) indices[found] = i;
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+// An active entity's box, copied out for the broadphase
+typedef struct BroadphaseBox
+{
+    float minX; // Sort key
+    float x, y, halfX, halfY;
+    int index;
+} BroadphaseBox;
+
+// Each cell's boxes, side by side and sorted by their left edge
+typedef struct Broadphase
+{
+    BroadphaseBox boxes[ENTITY_CAPACITY];
+    int runStart[ENTITY_CELL_CAPACITY];
+    int runCount[ENTITY_CELL_CAPACITY]; // 0 for free and parked cells
+    float runWidth[ENTITY_CELL_CAPACITY];    // Widest box in the run
+    float runHalfHeight[ENTITY_CELL_CAPACITY]; // Tallest box in the run, halved
+} Broadphase;
+
+// Insertion sort: runs are a cell's worth of entities, and this beats
+// qsort's indirect compares at that size
+static void sortBoxes(BroadphaseBox* run, int count) {
+    for (int i = 1; i < count; i++) {
+        BroadphaseBox box = run[i];
+        int j = i;
+        for (; j > 0 && run[j - 1].minX > box.minX; j--) run[j] = run[j - 1];
+        run[j] = box;
+    }
+}
+
+static void gatherBroadphase(Broadphase* broadphase) {
+    int total = 0;
+    for (int c = 0; c < ENTITY_CELL_CAPACITY; c++) {
+        const EntityCell* cell = &entities->cellTable[c];
+        broadphase->runCount[c] = 0;
+        if (cell->first < 0 || cell->parked) continue;
+
+        BroadphaseBox* run = &broadphase->boxes[total];
+        float width = 0.0f, halfHeight = 0.0f;
+        int count = 0;
+        for (int i = cell->first; i >= 0; i = entities->cellNext[i]) {
+            Vector2 position = entities->positions[i], half = entities->halfSizes[i];
+            run[count++] = (BroadphaseBox){position.x - half.x, position.x, position.y, half.x, half.y, i};
+            width = fmaxf(width, 2 * half.x);
+            halfHeight = fmaxf(halfHeight, half.y);
+        }
+        sortBoxes(run, count);
+        broadphase->runStart[c] = total;
+        broadphase->runCount[c] = count;
+        broadphase->runWidth[c] = width;
+        broadphase->runHalfHeight[c] = halfHeight;
+        total += count;
+    }
+}
+
+static inline bool boxesOverlap(const BroadphaseBox* a, const BroadphaseBox* b) {
+    return fabsf(wrapDeltaX(a->x, b->x)) < a->halfX + b->halfX && fabsf(b->y - a->y) < a->halfY + b->halfY;
+}
+
+static inline int addPair(EntityPair* pairs, int maxPairs, int found, int a, int b) {
+    if (found < maxPairs) pairs[found] = (EntityPair){a, b};
+    return found + 1;
+}
+
+// The sweep only bounds which boxes get the exact test; the slack keeps
+// rounding at the edges from hiding a pair the test would accept
+#define SWEEP_SLACK 0.01f
+
+static int sweepRun(const BroadphaseBox* run, int count, EntityPair* pairs, int maxPairs, int found) {
+    for (int i = 0; i < count; i++) {
+        float right = run[i].minX + 2 * run[i].halfX + SWEEP_SLACK;
+        for (int j = i + 1; j < count && run[j].minX < right; j++) {
+            if (boxesOverlap(&run[i], &run[j])) found = addPair(pairs, maxPairs, found, run[i].index, run[j].index);
+        }
+    }
+    return found;
+}
+
+// b's boxes are offset by shiftX, for a neighbour across the world seam.
+// Boxes of a entirely above minY or below maxY can't reach b's cell.
+static int sweepRuns(const BroadphaseBox* a, int countA, const BroadphaseBox* b, int countB, float widthB,
+                     float shiftX, float minY, float maxY, EntityPair* pairs, int maxPairs, int found) {
+    int first = 0;
+    for (int i = 0; i < countA; i++) {
+        if (a[i].y + a[i].halfY <= minY || a[i].y - a[i].halfY >= maxY) continue;
+        float left = a[i].minX - widthB - SWEEP_SLACK, right = a[i].minX + 2 * a[i].halfX + SWEEP_SLACK;
+        while (first < countB && b[first].minX + shiftX < left) first++;
+        for (int j = first; j < countB && b[j].minX + shiftX < right; j++) {
+            if (boxesOverlap(&a[i], &b[j])) found = addPair(pairs, maxPairs, found, a[i].index, b[j].index);
+        }
+    }
+    return found;
+}
+
+int findEntityPairs(EntityPair* pairs, int maxPairs) {
+    // Half the neighbours, so each pair of cells is tested once
+    static const int neighbors[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+    static Broadphase broadphase;
+    gatherBroadphase(&broadphase);
+
+    int found = 0;
+    for (int c = 0; c < ENTITY_CELL_CAPACITY; c++) {
+        int count = broadphase.runCount[c];
+        if (count == 0) continue;
+        const BroadphaseBox* run = &broadphase.boxes[broadphase.runStart[c]];
+        found = sweepRun(run, count, pairs, maxPairs, found);
+
+        const EntityCell* cell = &entities->cellTable[c];
+        for (int n = 0; n < 4; n++) {
+            int chunkX = cell->chunkX + neighbors[n][0];
+            int other = findCell(wrapChunkX(chunkX), cell->chunkY + neighbors[n][1], false);
+            if (other < 0 || broadphase.runCount[other] == 0) continue;
+            float shiftX = (chunkX >= WORLD_WIDTH_CHUNKS) ? WORLD_WIDTH_PIXELS : 0.0f;
+
+            // A cell above or below only reaches as far past the border as its tallest box
+            float reach = broadphase.runHalfHeight[other] + SWEEP_SLACK;
+            float minY = -INFINITY, maxY = INFINITY;
+            if (neighbors[n][1] > 0) minY = (cell->chunkY + 1) * CHUNK_PIXEL_SIZE - reach;
+            if (neighbors[n][1] < 0) maxY = cell->chunkY * CHUNK_PIXEL_SIZE + reach;
+            found = sweepRuns(run, count, &broadphase.boxes[broadphase.runStart[other]], broadphase.runCount[other],
+                              broadphase.runWidth[other], shiftX, minY, maxY, pairs, maxPairs, found);
+        }
+    }
+    return found;
+}
+
+void drawEntities(Vector2 viewCenter, float alpha) {
+    for (int i = 0; i < entities->activeCount; i++) {
+        Vector2 from = entities->prevPositions[i], to = entities->positions[i];
+        Vector2 half = entities->halfSizes[i];
+        Vector2 position = {from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha};
+        position.x = viewCenter.x + wrapDeltaX(viewCenter.x, position.x); // The copy nearest the view
+        DrawRectangleV((Vector2){position.x - half.x, position.y - half.y}, (Vector2){2 * half.x, 2 * half.y},
+                       typeColors[entities->types[i]]);
+    }
+}
+
+EntityStats getEntityStats() {
+    return entities->stats;
+}
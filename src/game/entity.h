@@ -0,0 +1,120 @@
+#pragma once
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "chunk.h"
+
+// Mobs, projectiles and items, stored as a struct of arrays: each field
+// is its own dense array indexed the same way, so a pass that only moves
+// things reads positions and velocities and nothing else. Removal swaps
+// the last entity into the hole, so indices are not stable; hold an
+// EntityId and look the index up when needed.
+//
+// The dense arrays are split in two: active entities first, then parked
+// ones, which sit in chunks that aren't loaded. Updates and queries only
+// walk the active part. An entity that moves into an unloaded chunk is
+// parked where it stands, and a chunk's entities are parked when it is
+// unloaded and woken when it is loaded again.
+//
+// The spatial index buckets entities by the chunk their center is in
+// (EntityCell, a small open-addressed table of the occupied chunks, each
+// with a list through the dense indices). An entity is only rebucketed
+// when it crosses a chunk border. Boxes are at most a chunk across, so
+// anything touching an entity is in its chunk or one of the eight around
+// it. The broadphase copies each cell's boxes out side by side, sorted by
+// X, and sweeps them against the cell's own and its neighbours'.
+//
+// Positions are world pixels with X wrapped, like the player's.
+
+#define ENTITY_CAPACITY 16384
+#define ENTITY_CELL_CAPACITY 4096 // Occupied chunks, parked included; a power of two
+#define ENTITY_MAX_HALF_SIZE (CHUNK_PIXEL_SIZE / 2.0f)
+
+typedef enum EntityType
+{
+    ENTITY_MOB,
+    ENTITY_PROJECTILE, // Gone on hitting a solid tile
+    ENTITY_ITEM,
+    ENTITY_TYPE_COUNT
+} EntityType;
+
+// Slot in the low 16 bits, the slot's generation above; 0 is never valid
+typedef uint32_t EntityId;
+
+typedef struct EntityCell
+{
+    int chunkX, chunkY; // X wrapped
+    int first;          // Dense index, -1 for an empty slot in the table
+    int count;
+    bool parked;
+} EntityCell;
+
+typedef struct EntityPair
+{
+    int a, b; // Dense indices
+} EntityPair;
+
+typedef struct EntityStats
+{
+    uint64_t updated;   // Entity updates, lifetime
+    uint64_t rebucketed; // Moves into another chunk, lifetime
+    uint64_t parked;    // Entities parked, lifetime
+    uint64_t woken;     // Entities woken, lifetime
+} EntityStats;
+
+// Allocated once from the host's arena
+typedef struct EntityState
+{
+    int count;       // Live entities
+    int activeCount; // [0, activeCount) are active, the rest up to count parked
+    EntityStats stats;
+
+    // Dense, per entity
+    Vector2 positions[ENTITY_CAPACITY];
+    Vector2 prevPositions[ENTITY_CAPACITY]; // Before the last update, for drawing
+    Vector2 velocities[ENTITY_CAPACITY];    // Pixels per second
+    Vector2 halfSizes[ENTITY_CAPACITY];     // AABB, from the center
+    uint8_t types[ENTITY_CAPACITY];
+    EntityId ids[ENTITY_CAPACITY];
+    int cells[ENTITY_CAPACITY];    // Index in cellTable
+    int cellNext[ENTITY_CAPACITY]; // Dense index of the next in the same cell, -1 at the end
+    int cellPrev[ENTITY_CAPACITY];
+
+    // Sparse, per slot of an EntityId
+    int slotIndex[ENTITY_CAPACITY]; // Dense index, -1 when free
+    uint16_t slotGeneration[ENTITY_CAPACITY];
+    int freeSlotCount;
+    uint16_t freeSlots[ENTITY_CAPACITY];
+
+    EntityCell cellTable[ENTITY_CELL_CAPACITY];
+} EntityState;
+
+void initEntities(EntityState* state);
+void bindEntities(EntityState* state);
+
+// 0 when the store (or the cell table) is full. halfSize is clamped to
+// ENTITY_MAX_HALF_SIZE.
+EntityId spawnEntity(EntityType type, Vector2 position, Vector2 velocity, Vector2 halfSize);
+bool despawnEntity(EntityId id);
+
+// Dense index, valid until the next spawn, despawn or update; -1 if gone
+int getEntityIndex(EntityId id);
+
+// Parks and wakes entities to match the loaded chunks, then moves every
+// active one by its velocity against the tiles
+void updateEntities(float dt);
+
+// Active entities whose boxes overlap the circle, as dense indices.
+// Returns how many were found, which may exceed maxCount.
+int queryEntities(Vector2 center, float radius, int* indices, int maxCount);
+
+// Every pair of active entities whose boxes overlap, each pair once.
+// Returns how many there are, which may exceed maxPairs.
+int findEntityPairs(EntityPair* pairs, int maxPairs);
+
+// Draws the active entities between their last two positions, each on
+// the side of the world seam nearest viewCenter
+void drawEntities(Vector2 viewCenter, float alpha);
+
+EntityStats getEntityStats();
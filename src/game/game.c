@@ -1,58 +1,223 @@
 #include "game.h"
 #include "chunk.h"
+#include "biome.h"
+#include "collision.h"
+#include "raycast.h"
+#include "tile_edit.h"
 
-static int frameCounter = 0; // For periodic cleanup
+#define PLAYER_SPEED 200.0f // Pixels per second
+#define PLAYER_HALF_SIZE 6.0f // Collision box, in pixels from the center
+#define PICK_RANGE 256.0f // How far the cursor ray reaches, in pixels
+#define DIG_RADIUS 2 // In tiles
+#define DIG_INTERVAL_TICKS 6
+#define MAX_ZOOM 4.0f
+#define MIN_UNLOAD_RADIUS 8
 
-EXPORT void gameTick(GameState *gameState)
+// Zooming out stops once the view spans the whole world width
+static float getMinZoom()
 {
-  setGameState(gameState);
+  return (float)GetScreenWidth() / WORLD_WIDTH_PIXELS;
+}
 
-  // Basic camera movement with arrow keys
-  Vector2 movement = {0};
-  if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) movement.x = -200.0f;
-  if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) movement.x = 200.0f;
-  if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W)) movement.y = -200.0f;
-  if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S)) movement.y = 200.0f;
-  
-  movement.x *= GetFrameTime();
-  movement.y *= GetFrameTime();
-  
-  gameState->playerPos.x += movement.x;
-  gameState->playerPos.y += movement.y;
+// Chunks stay loaded while they could still be on screen at this zoom,
+// otherwise a zoomed-out view would be unloaded and regenerated every second.
+// Past what the pool holds, the far chunks go instead of the new ones
+// failing to load.
+static int getUnloadRadius(float zoom, Vector2 viewSize)
+{
+  float screenSize = fmaxf(viewSize.x, viewSize.y);
+  int radius = (int)ceilf(screenSize / zoom / CHUNK_PIXEL_SIZE) + 1;
+  if (radius < MIN_UNLOAD_RADIUS) radius = MIN_UNLOAD_RADIUS;
+  int maxRadius = getMaxUnloadRadius();
+  return (radius < maxRadius) ? radius : maxRadius;
+}
+
+// What the sim sees of the keyboard, mouse and window this frame
+static GameInput readGameInput(const GameState *gameState)
+{
+  GameInput input = {0};
+  if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) input.moveX = -1.0f;
+  if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) input.moveX = 1.0f;
+  if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W)) input.moveY = -1.0f;
+  if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S)) input.moveY = 1.0f;
+  input.viewWidth = (float)GetScreenWidth();
+  input.viewHeight = (float)GetScreenHeight();
+
+  Vector2 aim = GetScreenToWorld2D(GetMousePosition(), gameState->camera);
+  input.aimX = aim.x;
+  input.aimY = aim.y;
+  input.dig = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+  return input;
+}
+
+
+// View controls act once per frame, not per sim step
+static void updateView(GameState *gameState)
+{
+  // Cycle chunk render modes
+  if (IsKeyPressed(KEY_F1)) {
+    gameState->renderMode = (gameState->renderMode + 1) % RENDER_MODE_COUNT;
+    setChunkRenderMode(gameState->renderMode);
+  }
+
+  // Toggle lighting
+  if (IsKeyPressed(KEY_F2)) {
+    gameState->lightOverlayOff = !gameState->lightOverlayOff;
+    setChunkLightOverlay(!gameState->lightOverlayOff);
+  }
+
+  // Zoom with the mouse wheel or +/-
+  float zoomSteps = GetMouseWheelMove();
+  if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) zoomSteps += 1.0f;
+  if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) zoomSteps -= 1.0f;
+  if (zoomSteps != 0.0f) {
+    float zoom = gameState->camera.zoom * powf(1.25f, zoomSteps);
+    gameState->camera.zoom = fminf(fmaxf(zoom, getMinZoom()), MAX_ZOOM);
+  }
+}
+
+// One fixed step of SIM_DT seconds
+static void simulateTick(GameState *gameState, const GameInput *input)
+{
+  Vector2 viewSize = {input->viewWidth, input->viewHeight};
+  gameState->prevPlayerPos = gameState->playerPos;
+  advanceChunkEditEpoch();
+
+  Vector2 delta = {input->moveX * PLAYER_SPEED * SIM_DT, input->moveY * PLAYER_SPEED * SIM_DT};
+  Vector2 halfSize = {PLAYER_HALF_SIZE, PLAYER_HALF_SIZE};
+  gameState->playerPos = sweepBox(gameState->playerPos, halfSize, delta).center;
   
   // Wrap player position horizontally for seamless world
   gameState->playerPos.x = wrapWorldX(gameState->playerPos.x);
+  if (gameState->playerPos.x - gameState->prevPlayerPos.x > WORLD_WIDTH_PIXELS / 2) {
+    gameState->prevPlayerPos.x += WORLD_WIDTH_PIXELS;
+  } else if (gameState->prevPlayerPos.x - gameState->playerPos.x > WORLD_WIDTH_PIXELS / 2) {
+    gameState->prevPlayerPos.x -= WORLD_WIDTH_PIXELS;
+  }
   
-  // Center camera on player
+  // Blast out the first solid tile on the ray from the player to the aim
+  // point. renderFrame's highlight casts from the interpolated position
+  // instead, so while the player moves it can mark a neighbouring tile.
+  if (input->dig && gameState->simTick >= gameState->nextDigTick) {
+    Vector2 from = gameState->playerPos;
+    TileRay digRay = {from, {input->aimX - from.x, input->aimY - from.y}, PICK_RANGE};
+    TileRayHit hit;
+    if (castTileRay(digRay, &hit)) {
+      fillCircle(hit.tileX, hit.tileY, DIG_RADIUS, TILE_AIR);
+      gameState->nextDigTick = gameState->simTick + DIG_INTERVAL_TICKS;
+    }
+  }
+
+  // Stream around where the camera will be
   gameState->camera.target = gameState->playerPos;
+  updateChunkStreaming(gameState->camera, viewSize);
+  updateLiquids();
+  updateLiquidLight();
+  updateEntities(SIM_DT);
   
-  // Periodic cleanup of distant chunks (every 60 frames = ~1 second)
-  frameCounter++;
-  if (frameCounter >= 60) {
-    unloadDistantChunks(gameState->playerPos, 8);
-    frameCounter = 0;
+  // Periodic cleanup of distant chunks, once a second
+  if (gameState->simTick % SIM_TICK_RATE == 0) {
+    unloadDistantChunks(gameState->playerPos, getUnloadRadius(gameState->camera.zoom, viewSize));
   }
 
+  gameState->simTick++;
+}
+
+// Draws the world alpha of the way from the previous sim state to the current one
+static void renderFrame(GameState *gameState, float alpha)
+{
+  Vector2 renderPos = {
+    gameState->prevPlayerPos.x + (gameState->playerPos.x - gameState->prevPlayerPos.x) * alpha,
+    gameState->prevPlayerPos.y + (gameState->playerPos.y - gameState->prevPlayerPos.y) * alpha,
+  };
+  
+  // Center camera on player
+  gameState->camera.target = renderPos;
+
   BeginDrawing();
   ClearBackground(SKYBLUE);
 
-  // Draw the infinite world using chunks (chunks auto-load as needed)
+  // Draw the resident chunks of the infinite world
   drawChunks(gameState->camera);
   
-  // Draw player
+  // Draw entities, then the player over them
   BeginMode2D(gameState->camera);
-  DrawCircle((int)gameState->playerPos.x, (int)gameState->playerPos.y, 8, RED);
+  drawEntities(renderPos, alpha);
+  DrawRectangleV((Vector2){renderPos.x - PLAYER_HALF_SIZE, renderPos.y - PLAYER_HALF_SIZE},
+                 (Vector2){2 * PLAYER_HALF_SIZE, 2 * PLAYER_HALF_SIZE}, RED);
+
+  // Line of sight towards the cursor, marking the first solid tile in reach
+  Vector2 cursor = GetScreenToWorld2D(GetMousePosition(), gameState->camera);
+  TileRay pickRay = {renderPos, {cursor.x - renderPos.x, cursor.y - renderPos.y}, PICK_RANGE};
+  TileRayHit pick;
+  if (castTileRay(pickRay, &pick)) {
+    DrawLineV(renderPos, pick.point, Fade(YELLOW, 0.5f));
+    DrawRectangleLines(pick.tileX * TILE_SIZE, pick.tileY * TILE_SIZE, TILE_SIZE, TILE_SIZE, YELLOW);
+  }
   EndMode2D();
 
   DrawFPS(10, 10);
-  DrawText("Use WASD/Arrow keys to explore the wrapping world!", 10, 30, 20, WHITE);
+  DrawText("Use WASD/Arrow keys to explore the wrapping world, click to dig!", 10, 30, 20, WHITE);
   
   Vector2 chunkCoord = worldToChunkCoord(gameState->playerPos);
-  DrawText(TextFormat("Player: (%.0f, %.0f) Chunk: (%.0f, %.0f) WorldWidth: %d", 
+  DrawText(TextFormat("Player: (%.0f, %.0f) Chunk: (%.0f, %.0f) WorldWidth: %d Biome: %s", 
                      gameState->playerPos.x, gameState->playerPos.y,
-                     chunkCoord.x, chunkCoord.y, WORLD_WIDTH_PIXELS), 10, 55, 16, WHITE);
+                     chunkCoord.x, chunkCoord.y, WORLD_WIDTH_PIXELS,
+                     getBiomeName(getBiomeAt((int)chunkCoord.x))), 10, 55, 16, WHITE);
+  DrawText(TextFormat("Render mode: %s (F1 to cycle) Lighting: %s (F2) Zoom: %.2f LOD: %d",
+                     getChunkRenderModeName(gameState->renderMode), gameState->lightOverlayOff ? "off" : "on",
+                     gameState->camera.zoom, pickChunkLod(gameState->camera.zoom)),
+           10, 75, 16, WHITE);
 
   drawUI();
 
   EndDrawing();
 }
+
+// One sim step without a window, for hosts that script their input
+EXPORT void gameSimulate(GameState *gameState, const GameInput *input)
+{
+  // Library statics start over after a hot reload, so re-bind from state
+  bindGameState(gameState);
+  simulateTick(gameState, input);
+}
+
+EXPORT void getGameStats(GameState *gameState, GameStats *stats)
+{
+  ChunkStats chunks = getChunkStats();
+  LiquidStats liquids = getLiquidStats();
+  *stats = (GameStats){
+      .simTicks = gameState->simTick,
+      .chunksCreated = chunks.created,
+      .chunksGenerated = chunks.generated,
+      .chunksUnloaded = chunks.unloaded,
+      .chunksResident = chunks.resident,
+      .chunkBytes = (uint64_t)chunks.resident * sizeof(ChunkNode),
+      .liquidCellsUpdated = liquids.cellsUpdated,
+      .liquidMoves = liquids.moves,
+      .liquidReactions = liquids.reactions,
+      .liquidAwakeChunks = liquids.awakeChunks,
+  };
+}
+
+EXPORT void gameTick(GameState *gameState)
+{
+  // Library statics start over after a hot reload, so re-bind from state
+  bindGameState(gameState);
+  updateView(gameState);
+
+  // Run as many fixed steps as the elapsed time covers
+  GameInput input = readGameInput(gameState);
+  gameState->simAccumulator += GetFrameTime();
+  int steps = 0;
+  while (gameState->simAccumulator >= SIM_DT && steps < MAX_SIM_STEPS_PER_FRAME) {
+    simulateTick(gameState, &input);
+    gameState->simAccumulator -= SIM_DT;
+    steps++;
+  }
+  if (steps == MAX_SIM_STEPS_PER_FRAME && gameState->simAccumulator >= SIM_DT) {
+    gameState->simAccumulator = 0.0f;
+  }
+
+  renderFrame(gameState, gameState->simAccumulator / SIM_DT);
+}
@@ -9,5 +9,8 @@
 #include "level.h"
 #include "game_state.h"
 #include "level_generator.h"
+#include "game_api.h"
 
 void gameTick(GameState *gameState);
+void gameSimulate(GameState *gameState, const GameInput *input);
+void getGameStats(GameState *gameState, GameStats *stats);
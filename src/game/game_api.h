@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Plain types shared between the game library and its hosts. Hosts only
+// see GameState as an opaque pointer, so everything they pass in or read
+// back goes through these.
+
+// Size of the block a host allocates and hands to initGameState. All
+// persistent game memory lives in it, so it survives a library reload,
+// unless the new build lays it out differently (see bindGameState).
+#define GAME_MEMORY_SIZE ((size_t)64 << 20)
+
+// Everything a simulation step reads from the outside world
+typedef struct GameInput
+{
+  float moveX, moveY;          // Movement direction, each in [-1, 1]
+  float viewWidth, viewHeight; // Screen size in pixels, drives chunk streaming
+  float aimX, aimY;            // World pixel under the cursor
+  bool dig;                    // Blast out the first solid tile towards the aim point
+} GameInput;
+
+typedef struct GameStats
+{
+  uint64_t simTicks;
+  uint64_t chunksCreated;
+  uint64_t chunksGenerated;
+  uint64_t chunksUnloaded;
+  int chunksResident;
+  uint64_t chunkBytes; // Memory held by resident chunks
+  uint64_t liquidCellsUpdated;
+  uint64_t liquidMoves;
+  uint64_t liquidReactions; // Lava-water contacts
+  int liquidAwakeChunks; // In the last tick
+} GameStats;
+
+// Result of one of the library's built-in benchmarks or checks
+typedef struct BenchReport
+{
+  uint64_t operations; // What the benchmark counts, see unit
+  double seconds;
+  char unit[32];
+  char detail[256]; // Free-form extra lines
+  int passed;       // For checks; benchmarks always pass
+} BenchReport;
+
+// Work the host can run on its own threads. parallelFor calls
+// job(context, i) for every i in [0, count) and returns once all of them
+// have finished; jobs may run on any thread and in any order.
+typedef void (*GameJobFuncT)(void *context, int index);
+
+typedef struct GamePlatform
+{
+  int workerCount; // Threads parallelFor spreads jobs over, the caller included
+  void (*parallelFor)(int count, GameJobFuncT job, void *context);
+} GamePlatform;
+
+typedef void *(*initGameStateFuncT)(void *memory, size_t size, const GamePlatform *platform);
+typedef void (*simulateFuncT)(void *gameState, const GameInput *input);
+typedef void (*statsFuncT)(void *gameState, GameStats *stats);
+typedef int (*benchFuncT)(void *gameState, const char *name, BenchReport *report);
@@ -1,11 +1,60 @@
 #include "game_state.h"
 #include "chunk.h"
+#include "jobs.h"
+#include <stdio.h>
+#include <time.h>
+
+// The world seed comes from WORLD_SEED when set, so a world can be
+// reproduced; otherwise every run gets a fresh one
+static uint32_t pickWorldSeed()
+{
+  const char *seedEnv = getenv("WORLD_SEED");
+  if (seedEnv && *seedEnv)
+  {
+    return (uint32_t)strtoul(seedEnv, NULL, 0);
+  }
+  return (uint32_t)time(NULL);
+}
 
 static GameState *gameState = NULL;
 
-EXPORT GameState *initGameState()
+// Sizes of everything initGameState pushes, so a rebuild that changes
+// any of them is caught before it reads the old block
+static uint64_t getLayoutHash()
+{
+  const size_t sizes[] = {
+      GAME_STATE_LAYOUT_VERSION, sizeof(GameState), sizeof(ChunkSystem), sizeof(DecorationState),
+      sizeof(BiomeCache), sizeof(ChunkRenderCache), sizeof(LiquidState), sizeof(LightState),
+      sizeof(PathfindState), sizeof(EntityState),
+  };
+  uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    hash = (hash ^ sizes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+EXPORT GameState *initGameState(void *memory, size_t size, const GamePlatform *platform)
 {
-  gameState = malloc(sizeof(GameState));
+  Arena arena;
+  initArena(&arena, memory, size);
+
+  gameState = ARENA_PUSH_STRUCT(&arena, GameState);
+  ChunkSystem *chunks = ARENA_PUSH_STRUCT(&arena, ChunkSystem);
+  DecorationState *decorations = ARENA_PUSH_STRUCT(&arena, DecorationState);
+  BiomeCache *biomes = ARENA_PUSH_STRUCT(&arena, BiomeCache);
+  ChunkRenderCache *renderCache = ARENA_PUSH_STRUCT(&arena, ChunkRenderCache);
+  LiquidState *liquids = ARENA_PUSH_STRUCT(&arena, LiquidState);
+  LightState *light = ARENA_PUSH_STRUCT(&arena, LightState);
+  PathfindState *pathfind = ARENA_PUSH_STRUCT(&arena, PathfindState);
+  EntityState *entities = ARENA_PUSH_STRUCT(&arena, EntityState);
+  if (!gameState || !chunks || !decorations || !biomes || !renderCache || !liquids || !light || !pathfind ||
+      !entities)
+  {
+    printf("Game memory too small: %zu bytes\n", size);
+    return NULL;
+  }
 
   Camera2D camera = {0};
   camera.zoom = 1.0f;
@@ -14,19 +63,76 @@ EXPORT GameState *initGameState()
   Vector2 playerPos = {0.0f, 100.0f}; // Start player at surface
 
   (*gameState) = (GameState){
+      .layoutHash = getLayoutHash(),
+      .memory = memory,
+      .memorySize = size,
+      .platform = platform ? *platform : (GamePlatform){0},
       .camera = camera,
       .playerPos = playerPos,
+      .prevPlayerPos = playerPos,
+      .worldGen = defaultWorldGenParams(pickWorldSeed()),
+      .renderMode = RENDER_MODE_ATLAS,
+      .chunks = chunks,
+      .decorations = decorations,
+      .biomes = biomes,
+      .renderCache = renderCache,
+      .liquids = liquids,
+      .light = light,
+      .pathfind = pathfind,
+      .entities = entities,
   };
 
-  // Initialize the chunk system
-  initChunkSystem();
-  
+  initChunkSystem(chunks);
+  initDecorations(decorations);
+  initLiquids(liquids);
+  initLight(light);
+  initPathfind(pathfind);
+  initEntities(entities);
+  bindGameState(gameState);
+  printf("World seed: %u (params hash %016llx)\n", gameState->worldGen.seed,
+         (unsigned long long)getWorldGenHash());
+
   // Load initial chunks around player spawn
   loadChunksAroundPosition(playerPos, 3);
 
+  // Everything is pushed by now, so GameState's copy has the final offset
+  gameState->arena = arena;
+  printf("Game memory: %zu of %zu bytes used\n", arena.used, arena.size);
+
   return gameState;
 }
 
+void bindGameState(GameState *state)
+{
+  // GPU textures the old render cache held are lost with it; the new
+  // world uploads its own
+  if (state->layoutHash != getLayoutHash())
+  {
+    printf("Game state layout changed in this build, starting a new world\n");
+    GamePlatform platform = state->platform;
+    if (initGameState(state->memory, state->memorySize, &platform) != state)
+    {
+      printf("Failed to lay out game state again\n");
+      exit(1);
+    }
+    return;
+  }
+
+  gameState = state;
+  bindJobs(&state->platform);
+  bindChunkSystem(state->chunks);
+  bindDecorations(state->decorations);
+  bindBiomeCache(state->biomes);
+  bindChunkRenderCache(state->renderCache);
+  bindLiquids(state->liquids);
+  bindLight(state->light);
+  bindPathfind(state->pathfind);
+  bindEntities(state->entities);
+  setWorldGenParams(&state->worldGen);
+  setChunkRenderMode(state->renderMode);
+  setChunkLightOverlay(!state->lightOverlayOff);
+}
+
 GameState *getGameState()
 {
   return gameState;
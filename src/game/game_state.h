@@ -3,17 +3,73 @@
 #include <raylib.h>
 #include "stdlib.h"
 #include "export.h"
+#include "world_gen.h"
+#include "chunk_render.h"
+#include "decoration.h"
+#include "biome.h"
+#include "liquid.h"
+#include "light.h"
+#include "pathfind.h"
+#include "entity.h"
+#include "arena.h"
+#include "game_api.h"
 
 // Forward declaration to avoid circular dependency
 struct GameState;
 
+// The simulation advances in fixed steps; rendering interpolates between
+// the last two simulated states
+#define SIM_TICK_RATE 60
+#define SIM_DT (1.0f / SIM_TICK_RATE)
+#define MAX_SIM_STEPS_PER_FRAME 5 // Beyond this, a slow frame drops time instead of spiralling
+
+// Bump when a struct kept in the host's block changes without changing
+// size (fields reordered or retyped), so the layout check below sees it
+#define GAME_STATE_LAYOUT_VERSION 1
+
 typedef struct GameState
 {
+  // These stay first and in this order, so a build with a different
+  // layout can still read them. bindGameState compares layoutHash with
+  // its own and lays the block out afresh (a new world) when they differ,
+  // rather than reading the old one at the wrong offsets.
+  uint64_t layoutHash;
+  void *memory; // The host's block, to lay out again
+  size_t memorySize;
+  GamePlatform platform; // The host's worker threads; host code, so it survives reloads
+
   Camera2D camera;
   Vector2 playerPos; // Track player position for chunk loading
+  Vector2 prevPlayerPos; // playerPos before the last sim step
+  float simAccumulator; // Unsimulated time, always below SIM_DT between frames
+  uint64_t simTick;
+  uint64_t nextDigTick; // Digging is rate limited to one blast per DIG_INTERVAL_TICKS
+  WorldGenParams worldGen; // Seed and rules the world is generated from
+  ChunkRenderMode renderMode;
+  bool lightOverlayOff;
+
+  // Persistent memory, all inside the host's block. The library rebinds
+  // its modules to these every tick, so they outlive a hot reload.
+  Arena arena;
+  ChunkSystem *chunks;
+  DecorationState *decorations;
+  BiomeCache *biomes;
+  ChunkRenderCache *renderCache;
+  LiquidState *liquids;
+  LightState *light;
+  PathfindState *pathfind;
+  EntityState *entities;
 } GameState;
 
-EXPORT GameState *initGameState();
+// Lays GameState and everything it owns out in memory the host allocated
+// (GAME_MEMORY_SIZE bytes, see game_api.h). Returns NULL if it doesn't fit.
+// platform may be NULL, in which case everything runs on the caller's thread.
+EXPORT GameState *initGameState(void *memory, size_t size, const GamePlatform *platform);
+
+// Points every module at the storage in gameState. If the library was
+// rebuilt with a different layout since initGameState, starts a new world
+// in the same block first.
+void bindGameState(GameState *state);
 
 GameState *getGameState();
 
@@ -0,0 +1,20 @@
+#include "jobs.h"
+#include <stddef.h>
+
+static const GamePlatform* platform = NULL;
+
+void bindJobs(const GamePlatform* hostPlatform) {
+    platform = hostPlatform;
+}
+
+void runJobs(int count, GameJobFuncT job, void* context, bool parallel) {
+    if (parallel && platform && platform->parallelFor && platform->workerCount > 1) {
+        platform->parallelFor(count, job, context);
+        return;
+    }
+    for (int i = 0; i < count; i++) job(context, i);
+}
+
+int getJobThreadCount() {
+    return (platform && platform->parallelFor && platform->workerCount > 1) ? platform->workerCount : 1;
+}
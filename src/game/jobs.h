@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdbool.h>
+#include "game_api.h"
+
+// Spreads independent jobs over the host's worker threads (see
+// GamePlatform in game_api.h). Without a host pool, or when the caller
+// asks for it, the jobs run in order on the calling thread instead, so
+// every system written against this also works single-threaded.
+
+void bindJobs(const GamePlatform* platform);
+
+// Runs job(context, i) for every i in [0, count), returning once all are done
+void runJobs(int count, GameJobFuncT job, void* context, bool parallel);
+
+// Threads runJobs can use, the caller included
+int getJobThreadCount();
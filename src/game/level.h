@@ -14,6 +14,7 @@ typedef enum TileType
   TILE_ROCK,
   TILE_WATER,
   TILE_LAVA,
+  TILE_TYPE_COUNT
 } TileType;
 
 typedef struct Level
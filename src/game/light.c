@@ -0,0 +1,235 @@
+#include "light.h"
+#include "liquid.h"
+#include "occupancy.h"
+#include "world_gen.h"
+#include <string.h>
+
+static LightState* lights = NULL;
+
+enum { DIR_LEFT, DIR_RIGHT, DIR_UP, DIR_DOWN, DIR_COUNT };
+static const int dirX[DIR_COUNT] = {-1, 1, 0, 0};
+static const int dirY[DIR_COUNT] = {0, 0, -1, 1};
+
+void initLight(LightState* state) {
+    lights = state;
+    state->pass = 0;
+    state->removals.head = state->removals.count = 0;
+    state->additions.head = state->additions.count = 0;
+    state->invalidatedCount = 0;
+    memset(&state->stats, 0, sizeof(state->stats));
+}
+
+void bindLight(LightState* state) {
+    lights = state;
+}
+
+static void pushNode(LightQueue* queue, LightNode node) {
+    if (queue->count == LIGHT_QUEUE_CAPACITY) {
+        lights->stats.overflows++;
+        return;
+    }
+    queue->nodes[(queue->head + queue->count) & (LIGHT_QUEUE_CAPACITY - 1)] = node;
+    queue->count++;
+}
+
+static LightNode popNode(LightQueue* queue) {
+    LightNode node = queue->nodes[queue->head];
+    queue->head = (queue->head + 1) & (LIGHT_QUEUE_CAPACITY - 1);
+    queue->count--;
+    return node;
+}
+
+// Chunks that take part in lighting; the rest count as absent
+static Chunk* getLitChunk(int chunkX, int chunkY) {
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    return (chunk && chunk->generated && chunk->light.lit) ? chunk : NULL;
+}
+
+// The neighbouring cell in a direction, crossing into the next chunk
+// when needed. False when that chunk isn't lit.
+static inline bool stepCell(Chunk* chunk, int x, int y, int dir, Chunk** outChunk, int* outX, int* outY) {
+    int nx = x + dirX[dir];
+    int ny = y + dirY[dir];
+    if (nx >= 0 && nx < CHUNK_SIZE && ny >= 0 && ny < CHUNK_SIZE) {
+        *outChunk = chunk;
+        *outX = nx;
+        *outY = ny;
+        return true;
+    }
+
+    Chunk* next = getLitChunk(chunk->x + dirX[dir], chunk->y + dirY[dir]);
+    if (!next) return false;
+    *outChunk = next;
+    *outX = nx & (CHUNK_SIZE - 1);
+    *outY = ny & (CHUNK_SIZE - 1);
+    return true;
+}
+
+static inline void setLightLevel(Chunk* chunk, int x, int y, int channel, int level) {
+    uint8_t* levels = &chunk->light.levels[x][y];
+    *levels = (channel == LIGHT_SKY) ? (uint8_t)((*levels & 0x0f) | (level << 4)) : (uint8_t)((*levels & 0xf0) | level);
+    if (chunk->light.pass != lights->pass) {
+        chunk->light.pass = lights->pass;
+        chunk->light.version++;
+    }
+}
+
+// What a neighbour in direction dir gets from a cell at level
+static inline int spreadLevel(int level, int dir, int channel, TileType into) {
+    if (isSolidTile(into)) return level - LIGHT_SOLID_FALLOFF;
+    if (channel == LIGHT_SKY && dir == DIR_DOWN && level == LIGHT_MAX) return LIGHT_MAX;
+    return level - 1;
+}
+
+// Raises a cell to level and queues it to spread, if that is brighter
+static inline void raiseLevel(Chunk* chunk, int x, int y, int channel, int level) {
+    if (level <= getLightLevel(chunk, x, y, channel)) return;
+    setLightLevel(chunk, x, y, channel, level);
+    pushNode(&lights->additions, (LightNode){chunk, (uint8_t)x, (uint8_t)y, (uint8_t)channel, 0});
+}
+
+static inline bool hasOpenSkyAbove(const Chunk* chunk, int y) {
+    return y == 0 && chunk->light.openSky && !getLitChunk(chunk->x, chunk->y - 1);
+}
+
+void invalidateLight(Chunk* chunk, int x, int y) {
+    if (!lights) return;
+    if (lights->invalidatedCount == LIGHT_MAX_INVALIDATED) propagateLight();
+
+    for (int channel = 0; channel < LIGHT_CHANNEL_COUNT; channel++) {
+        int level = getLightLevel(chunk, x, y, channel);
+        if (level == 0) continue;
+        setLightLevel(chunk, x, y, channel, 0);
+        pushNode(&lights->removals, (LightNode){chunk, (uint8_t)x, (uint8_t)y, (uint8_t)channel, (uint8_t)level});
+    }
+    lights->invalidatedCount++;
+    lights->invalidated[lights->invalidatedCount - 1] = (LightNode){chunk, (uint8_t)x, (uint8_t)y, 0, 0};
+}
+
+// Darkens whatever was lit through the removed cells. A neighbour dimmer
+// than the removed level got its light from there (as did a sky column
+// below a full-strength cell) and goes too; a brighter one has another
+// source and is queued to flood back in.
+static void runRemovals() {
+    while (lights->removals.count) {
+        LightNode node = popNode(&lights->removals);
+        lights->stats.cellsVisited++;
+
+        for (int dir = 0; dir < DIR_COUNT; dir++) {
+            Chunk* chunk;
+            int x, y;
+            if (!stepCell(node.chunk, node.x, node.y, dir, &chunk, &x, &y)) continue;
+
+            int level = getLightLevel(chunk, x, y, node.channel);
+            if (level == 0) continue;
+            bool skyColumn = node.channel == LIGHT_SKY && dir == DIR_DOWN && node.level == LIGHT_MAX && level == LIGHT_MAX;
+            if (level < node.level || skyColumn) {
+                setLightLevel(chunk, x, y, node.channel, 0);
+                pushNode(&lights->removals, (LightNode){chunk, (uint8_t)x, (uint8_t)y, node.channel, (uint8_t)level});
+            } else {
+                pushNode(&lights->additions, (LightNode){chunk, (uint8_t)x, (uint8_t)y, node.channel, 0});
+            }
+        }
+    }
+}
+
+// Light flows back into the invalidated cells from their own emitters,
+// from open sky and from every lit neighbour
+static void reseedInvalidated() {
+    for (int i = 0; i < lights->invalidatedCount; i++) {
+        LightNode cell = lights->invalidated[i];
+        TileType tile = cell.chunk->tiles[cell.x][cell.y];
+        if (tile == TILE_LAVA) raiseLevel(cell.chunk, cell.x, cell.y, LIGHT_BLOCK, LAVA_LIGHT);
+        if (hasOpenSkyAbove(cell.chunk, cell.y)) {
+            raiseLevel(cell.chunk, cell.x, cell.y, LIGHT_SKY, spreadLevel(LIGHT_MAX, DIR_DOWN, LIGHT_SKY, tile));
+        }
+
+        for (int dir = 0; dir < DIR_COUNT; dir++) {
+            Chunk* chunk;
+            int x, y;
+            if (!stepCell(cell.chunk, cell.x, cell.y, dir, &chunk, &x, &y)) continue;
+            for (int channel = 0; channel < LIGHT_CHANNEL_COUNT; channel++) {
+                if (getLightLevel(chunk, x, y, channel) == 0) continue;
+                pushNode(&lights->additions, (LightNode){chunk, (uint8_t)x, (uint8_t)y, (uint8_t)channel, 0});
+            }
+        }
+    }
+    lights->invalidatedCount = 0;
+}
+
+static void runAdditions() {
+    while (lights->additions.count) {
+        LightNode node = popNode(&lights->additions);
+        lights->stats.cellsVisited++;
+
+        int level = getLightLevel(node.chunk, node.x, node.y, node.channel);
+        if (level <= 1) continue;
+        for (int dir = 0; dir < DIR_COUNT; dir++) {
+            Chunk* chunk;
+            int x, y;
+            if (!stepCell(node.chunk, node.x, node.y, dir, &chunk, &x, &y)) continue;
+            raiseLevel(chunk, x, y, node.channel, spreadLevel(level, dir, node.channel, chunk->tiles[x][y]));
+        }
+    }
+}
+
+void propagateLight() {
+    if (!lights || (!lights->invalidatedCount && !lights->removals.count && !lights->additions.count)) return;
+
+    lights->pass++;
+    lights->stats.passes++;
+    runRemovals();
+    reseedInvalidated();
+    runAdditions();
+}
+
+void lightChunk(Chunk* chunk) {
+    if (!lights) return;
+
+    chunk->light.lit = true;
+    chunk->light.openSky = !getLitChunk(chunk->x, chunk->y - 1) &&
+                           (chunk->y + 1) * CHUNK_SIZE <= getWorldGenParams()->surfaceLevel;
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) invalidateLight(chunk, x, y);
+    }
+
+    // The chunk below may have guessed open sky; now it knows what is above
+    Chunk* below = getLitChunk(chunk->x, chunk->y + 1);
+    if (below && below->light.openSky) {
+        below->light.openSky = false;
+        for (int x = 0; x < CHUNK_SIZE; x++) invalidateLight(below, x, 0);
+    }
+    propagateLight();
+}
+
+void updateLiquidLight() {
+    if (!lights) return;
+
+    int count = 0;
+    const ChunkCoord* coords = getLavaChangedChunks(&count);
+    for (int i = 0; i < count; i++) {
+        Chunk* chunk = getLitChunk(coords[i].x, coords[i].y);
+        uint64_t cells[CHUNK_CELL_WORDS];
+        if (!chunk || !takeLavaChangedCells(chunk, cells)) continue;
+
+        // Only the cells lava left, reached or set in, and those around them
+        for (int word = 0; word < CHUNK_CELL_WORDS; word++) {
+            for (uint64_t bits = cells[word]; bits; bits &= bits - 1) {
+                int bit = word * 64 + __builtin_ctzll(bits);
+                int x = bit % CHUNK_SIZE;
+                int y = bit / CHUNK_SIZE;
+                invalidateLight(chunk, x, y);
+                for (int dir = 0; dir < DIR_COUNT; dir++) {
+                    Chunk* next;
+                    int nx, ny;
+                    if (stepCell(chunk, x, y, dir, &next, &nx, &ny)) invalidateLight(next, nx, ny);
+                }
+            }
+        }
+    }
+    propagateLight();
+}
+
+LightStats getLightStats() {
+    return lights->stats;
+}
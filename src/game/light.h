@@ -0,0 +1,101 @@
+#pragma once
+
+#include "chunk.h"
+
+// Tile lighting, two channels of 0 to LIGHT_MAX per tile (ChunkLight):
+// sky light, which falls straight down through open tiles at full
+// strength, and block light from emitters (lava). Both spread to the four
+// neighbours losing 1 per open tile and LIGHT_SOLID_FALLOFF per solid one,
+// so walls are lit a few tiles deep and cave interiors stay dark.
+//
+// Light is only ever updated incrementally, as a breadth-first flood over
+// two queues. Changing a tile invalidates it: its old levels go on the
+// removal queue, which darkens everything that was lit through it and
+// collects the brighter cells at the edge of the darkened area. Those, any
+// emitter, and the invalidated cell's neighbours then go on the add queue,
+// which floods light back in. A single edit only touches the area its old
+// and new light reach.
+//
+// A freshly generated chunk is lit the same way, from its own emitters and
+// its lit neighbours' borders, and pushes its own light out into them.
+// With no chunk loaded above it, a chunk above the mean surface assumes
+// open sky and one below it assumes darkness; the guess is corrected when
+// the chunk above arrives. Unloading leaves the neighbours as they are.
+
+#define LIGHT_MAX 15
+#define LAVA_LIGHT 15
+#define LIGHT_SOLID_FALLOFF 4 // Light lost entering a solid tile; open tiles lose 1
+#define LIGHT_QUEUE_CAPACITY (1 << 18)
+#define LIGHT_MAX_INVALIDATED (1 << 15) // Invalidated cells per pass; more flush a pass early
+
+typedef enum LightChannel
+{
+    LIGHT_BLOCK, // Low nibble
+    LIGHT_SKY,   // High nibble
+    LIGHT_CHANNEL_COUNT
+} LightChannel;
+
+typedef struct LightNode
+{
+    Chunk* chunk;
+    uint8_t x, y;
+    uint8_t channel;
+    uint8_t level; // Removal queue: the level the cell had
+} LightNode;
+
+// Ring buffer
+typedef struct LightQueue
+{
+    uint32_t head;
+    uint32_t count;
+    LightNode nodes[LIGHT_QUEUE_CAPACITY];
+} LightQueue;
+
+typedef struct LightStats
+{
+    uint64_t passes;       // Propagation passes, lifetime
+    uint64_t cellsVisited; // Queue nodes processed, lifetime
+    uint64_t overflows;    // Nodes dropped on a full queue, lifetime; light may be stale
+} LightStats;
+
+// Queues and pending invalidations, allocated once from the host's arena
+typedef struct LightState
+{
+    uint64_t pass;
+    LightStats stats;
+    LightQueue removals;
+    LightQueue additions;
+    int invalidatedCount;
+    LightNode invalidated[LIGHT_MAX_INVALIDATED]; // Cells to reseed after removal
+} LightState;
+
+void initLight(LightState* state);
+void bindLight(LightState* state);
+
+static inline int getLightLevel(const Chunk* chunk, int x, int y, LightChannel channel) {
+    uint8_t levels = chunk->light.levels[x][y];
+    return (channel == LIGHT_SKY) ? levels >> 4 : levels & 0xf;
+}
+
+// The brighter of the two channels, what a renderer shows
+static inline int getTileLight(const Chunk* chunk, int x, int y) {
+    uint8_t levels = chunk->light.levels[x][y];
+    int sky = levels >> 4;
+    int block = levels & 0xf;
+    return (sky > block) ? sky : block;
+}
+
+// (Re)lights a whole chunk from its tiles and its lit neighbours; on
+// generation and after changes that may have touched every tile
+void lightChunk(Chunk* chunk);
+
+// Marks a cell whose tile changed. Nothing is relit until propagateLight.
+void invalidateLight(Chunk* chunk, int x, int y);
+
+// Runs the removal and add floods for everything invalidated since the last pass
+void propagateLight();
+
+// Relights around the cells where the last updateLiquids moved or set lava
+void updateLiquidLight();
+
+LightStats getLightStats();
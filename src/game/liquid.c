@@ -0,0 +1,413 @@
+#include "liquid.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include <stdlib.h>
+#include <string.h>
+
+static LiquidState* liquids = NULL;
+
+// A chunk and its eight neighbours, looked up once per processed chunk.
+// Cells are addressed relative to the center chunk, from -1 to CHUNK_SIZE.
+typedef struct Neighborhood
+{
+    Chunk* chunks[3][3];
+} Neighborhood;
+
+typedef struct Cell
+{
+    Chunk* chunk; // NULL outside the loaded world
+    int x, y;
+} Cell;
+
+// One phase's chunks, handed out LIQUID_JOB_CHUNKS at a time
+typedef struct PhaseJobs
+{
+    Chunk** chunks;
+    int count;
+} PhaseJobs;
+
+void initLiquids(LiquidState* state) {
+    liquids = state;
+    state->singleThreaded = false;
+    resetLiquids();
+}
+
+void bindLiquids(LiquidState* state) {
+    liquids = state;
+}
+
+void resetLiquids() {
+    liquids->tick = 0;
+    liquids->awakeCount = 0;
+    liquids->nextCount = 0;
+    liquids->eventCount = 0;
+    liquids->lavaChunkCount = 0;
+    memset(&liquids->stats, 0, sizeof(liquids->stats));
+}
+
+void setLiquidsSingleThreaded(bool singleThreaded) {
+    liquids->singleThreaded = singleThreaded;
+}
+
+static inline int cellBit(int x, int y) {
+    return y * CHUNK_SIZE + x;
+}
+
+// Adds the chunk to the list for the coming tick, once. Whichever thread
+// swaps in the new tick lists it; the list is sorted before it is used.
+static void listChunk(Chunk* chunk) {
+    uint64_t nextTick = liquids->tick + 1;
+    if (__atomic_load_n(&chunk->liquid.listedTick, __ATOMIC_RELAXED) == nextTick) return;
+    if (__atomic_exchange_n(&chunk->liquid.listedTick, nextTick, __ATOMIC_RELAXED) == nextTick) return;
+
+    int index = __atomic_fetch_add(&liquids->nextCount, 1, __ATOMIC_RELAXED);
+    if (index < LIQUID_MAX_AWAKE_CHUNKS) liquids->next[index] = (ChunkCoord){chunk->x, chunk->y};
+}
+
+static void setPending(Chunk* chunk, int x, int y) {
+    int bit = cellBit(x, y);
+    __atomic_fetch_or(&chunk->liquid.pending[bit >> 6], 1ull << (bit & 63), __ATOMIC_RELAXED);
+    listChunk(chunk);
+}
+
+void wakeChunkLiquids(Chunk* chunk) {
+    if (!liquids) return;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            if (isLiquid(chunk->tiles[x][y])) setPending(chunk, x, y);
+        }
+    }
+
+    // Liquid that was resting on this chunk's (previously solid) border
+    Chunk* above = getChunk(chunk->x, chunk->y - 1);
+    Chunk* left = getChunk(chunk->x - 1, chunk->y);
+    Chunk* right = getChunk(chunk->x + 1, chunk->y);
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+        if (above && above->generated && isLiquid(above->tiles[i][CHUNK_SIZE - 1])) {
+            setPending(above, i, CHUNK_SIZE - 1);
+        }
+        if (left && left->generated && isLiquid(left->tiles[CHUNK_SIZE - 1][i])) {
+            setPending(left, CHUNK_SIZE - 1, i);
+        }
+        if (right && right->generated && isLiquid(right->tiles[0][i])) {
+            setPending(right, 0, i);
+        }
+    }
+}
+
+void wakeLiquidRegion(Chunk* chunk, int minX, int minY, int maxX, int maxY) {
+    if (!liquids) return;
+
+    for (int x = minX; x <= maxX; x++) {
+        for (int y = minY; y <= maxY; y++) {
+            if (isLiquid(chunk->tiles[x][y])) setPending(chunk, x, y);
+        }
+    }
+}
+
+static void loadNeighborhood(Neighborhood* n, Chunk* center) {
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            Chunk* chunk = (dx == 0 && dy == 0) ? center : getChunk(center->x + dx, center->y + dy);
+            n->chunks[dx + 1][dy + 1] = (chunk && chunk->generated) ? chunk : NULL;
+        }
+    }
+}
+
+static inline Cell resolveCell(const Neighborhood* n, int x, int y) {
+    int cx = (x < 0) ? 0 : (x >= CHUNK_SIZE ? 2 : 1);
+    int cy = (y < 0) ? 0 : (y >= CHUNK_SIZE ? 2 : 1);
+    return (Cell){n->chunks[cx][cy], x - (cx - 1) * CHUNK_SIZE, y - (cy - 1) * CHUNK_SIZE};
+}
+
+// Unloaded cells read as rock, so nothing flows out of the loaded world
+static inline TileType cellTile(Cell cell) {
+    return cell.chunk ? cell.chunk->tiles[cell.x][cell.y] : TILE_ROCK;
+}
+
+static inline TileType tileAt(const Neighborhood* n, int x, int y) {
+    return cellTile(resolveCell(n, x, y));
+}
+
+// Only the thread that swaps in the tick bumps the version
+static void markModified(Chunk* chunk) {
+    if (__atomic_load_n(&chunk->liquid.modifiedTick, __ATOMIC_RELAXED) == liquids->tick) return;
+    if (__atomic_exchange_n(&chunk->liquid.modifiedTick, liquids->tick, __ATOMIC_RELAXED) == liquids->tick) return;
+    markChunkChanged(chunk);
+}
+
+// Records a cell where lava moved or set, and lists its chunk in the
+// tick's lava changes, once, like markModified
+static void markLavaChanged(Cell cell) {
+    Chunk* chunk = cell.chunk;
+    int bit = cellBit(cell.x, cell.y);
+    __atomic_fetch_or(&chunk->liquid.lavaCells[bit >> 6], 1ull << (bit & 63), __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&chunk->liquid.lavaTick, __ATOMIC_RELAXED) == liquids->tick) return;
+    if (__atomic_exchange_n(&chunk->liquid.lavaTick, liquids->tick, __ATOMIC_RELAXED) == liquids->tick) return;
+
+    int index = __atomic_fetch_add(&liquids->lavaChunkCount, 1, __ATOMIC_RELAXED);
+    if (index < LIQUID_MAX_AWAKE_CHUNKS) liquids->lavaChunks[index] = (ChunkCoord){chunk->x, chunk->y};
+}
+
+// Whatever could flow into a cell that just emptied
+static void wakeAround(const Neighborhood* n, int x, int y) {
+    static const int wakeOffsets[5][2] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}};
+    for (int i = 0; i < 5; i++) {
+        Cell neighbor = resolveCell(n, x + wakeOffsets[i][0], y + wakeOffsets[i][1]);
+        if (neighbor.chunk && isLiquid(cellTile(neighbor))) setPending(neighbor.chunk, neighbor.x, neighbor.y);
+    }
+}
+
+static void moveLiquid(const Neighborhood* n, LiquidJob* job, int x, int y, int toX, int toY) {
+    Cell from = resolveCell(n, x, y);
+    Cell to = resolveCell(n, toX, toY);
+
+    TileType tile = from.chunk->tiles[from.x][from.y];
+    to.chunk->tiles[to.x][to.y] = tile;
+    from.chunk->tiles[from.x][from.y] = TILE_AIR;
+    markModified(from.chunk);
+    markModified(to.chunk);
+    if (tile == TILE_LAVA) {
+        markLavaChanged(from);
+        markLavaChanged(to);
+    }
+
+    // The liquid already moved this tick; it carries on in the next one
+    int bit = cellBit(to.x, to.y);
+    __atomic_fetch_and(&to.chunk->liquid.active[bit >> 6], ~(1ull << (bit & 63)), __ATOMIC_RELAXED);
+    setPending(to.chunk, to.x, to.y);
+
+    wakeAround(n, x, y);
+    job->moves++;
+}
+
+static void emitEvent(LiquidJob* job, Cell cell, LiquidEventType type) {
+    if (job->eventCount == LIQUID_JOB_EVENTS) {
+        job->droppedEvents++;
+        return;
+    }
+    job->events[job->eventCount++] = (LiquidEvent){
+        cell.chunk->x * CHUNK_SIZE + cell.x,
+        cell.chunk->y * CHUNK_SIZE + cell.y,
+        type,
+    };
+}
+
+// Lava at one cell, water at the other: the lava sets, the water boils off
+static void react(const Neighborhood* n, LiquidJob* job, int lavaX, int lavaY, int waterX, int waterY) {
+    Cell lava = resolveCell(n, lavaX, lavaY);
+    Cell water = resolveCell(n, waterX, waterY);
+
+    lava.chunk->tiles[lava.x][lava.y] = TILE_ROCK;
+    water.chunk->tiles[water.x][water.y] = TILE_AIR;
+    updateSolidCell(lava.chunk, lava.x, lava.y);
+    markModified(lava.chunk);
+    markModified(water.chunk);
+    markLavaChanged(lava);
+
+    wakeAround(n, waterX, waterY);
+    emitEvent(job, lava, LIQUID_EVENT_ROCK);
+    emitEvent(job, water, LIQUID_EVENT_STEAM);
+    job->reactions++;
+}
+
+// Falls straight down, then diagonally, then spreads sideways. Sideways
+// moves need a reason (room to fall next, or liquid pressing from above),
+// so a lone cell on flat ground comes to rest instead of wandering.
+// Returns false when the cell should sleep.
+static bool updateCell(const Neighborhood* n, LiquidJob* job, int x, int y) {
+    TileType tile = tileAt(n, x, y);
+    if (!isLiquid(tile)) return false;
+
+    // The four neighbours decide both reactions and most of the flow
+    TileType below = tileAt(n, x, y + 1);
+    TileType above = tileAt(n, x, y - 1);
+    TileType sides[2] = {tileAt(n, x - 1, y), tileAt(n, x + 1, y)};
+
+    // Contact with the other liquid wins over flowing
+    TileType other = (tile == TILE_LAVA) ? TILE_WATER : TILE_LAVA;
+    if (below == other || above == other || sides[0] == other || sides[1] == other) {
+        int nx = x, ny = y;
+        if (below == other) {
+            ny = y + 1;
+        } else if (above == other) {
+            ny = y - 1;
+        } else {
+            nx = (sides[0] == other) ? x - 1 : x + 1;
+        }
+
+        if (tile == TILE_LAVA) {
+            react(n, job, x, y, nx, ny);
+        } else {
+            react(n, job, nx, ny, x, y);
+        }
+        return true;
+    }
+
+    if (below == TILE_AIR) {
+        moveLiquid(n, job, x, y, x, y + 1);
+        return true;
+    }
+
+    // Alternate the preferred side so pools level out evenly
+    int dir = ((liquids->tick + x + y) & 1) ? 1 : -1;
+    for (int i = 0; i < 2; i++, dir = -dir) {
+        if (sides[dir > 0] == TILE_AIR && tileAt(n, x + dir, y + 1) == TILE_AIR) {
+            moveLiquid(n, job, x, y, x + dir, y + 1);
+            return true;
+        }
+    }
+
+    bool pressed = isLiquid(above);
+    for (int i = 0; i < 2; i++, dir = -dir) {
+        if (sides[dir > 0] != TILE_AIR) continue;
+        if (!pressed && tileAt(n, x + dir, y + 1) != TILE_AIR) continue;
+
+        // Lava is viscous: it waits for its turn but stays awake for it
+        if (tile == TILE_LAVA && liquids->tick % LAVA_FLOW_INTERVAL != 0) {
+            Cell cell = resolveCell(n, x, y);
+            setPending(cell.chunk, cell.x, cell.y);
+            return true;
+        }
+        moveLiquid(n, job, x, y, x + dir, y);
+        return true;
+    }
+    return false;
+}
+
+// Bottom row first, so a falling column moves as one
+static void updateChunk(Chunk* chunk, LiquidJob* job) {
+    Neighborhood n;
+    loadNeighborhood(&n, chunk);
+
+    for (int word = CHUNK_CELL_WORDS - 1; word >= 0; word--) {
+        // Re-read every step: moves clear bits of cells they fill. No other
+        // thread touches this chunk's bits while it is being processed.
+        while (chunk->liquid.active[word]) {
+            int bit = 63 - __builtin_clzll(chunk->liquid.active[word]);
+            chunk->liquid.active[word] &= ~(1ull << bit);
+
+            int index = word * 64 + bit;
+            updateCell(&n, job, index % CHUNK_SIZE, index / CHUNK_SIZE);
+            job->cellsUpdated++;
+        }
+    }
+}
+
+static int compareChunkCoords(const void* a, const void* b) {
+    const ChunkCoord* ca = a;
+    const ChunkCoord* cb = b;
+    if (ca->y != cb->y) return (ca->y < cb->y) ? -1 : 1;
+    return (ca->x > cb->x) - (ca->x < cb->x);
+}
+
+static inline int chunkPhase(int x, int y) {
+    return (x & 1) | ((y & 1) << 1);
+}
+
+static void runPhaseJob(void* context, int index) {
+    PhaseJobs* phase = context;
+    int start = index * LIQUID_JOB_CHUNKS;
+    int end = start + LIQUID_JOB_CHUNKS;
+    if (end > phase->count) end = phase->count;
+
+    LiquidJob* job = &liquids->jobs[index];
+    job->cellsUpdated = 0;
+    job->moves = 0;
+    job->reactions = 0;
+    job->droppedEvents = 0;
+    job->eventCount = 0;
+    for (int i = start; i < end; i++) updateChunk(phase->chunks[i], job);
+}
+
+static void mergeJob(const LiquidJob* job) {
+    liquids->stats.cellsUpdated += job->cellsUpdated;
+    liquids->stats.moves += job->moves;
+    liquids->stats.reactions += job->reactions;
+    liquids->stats.droppedEvents += job->droppedEvents;
+
+    int room = LIQUID_MAX_EVENTS - liquids->eventCount;
+    int count = (job->eventCount < room) ? job->eventCount : room;
+    memcpy(liquids->events + liquids->eventCount, job->events, count * sizeof(LiquidEvent));
+    liquids->eventCount += count;
+    liquids->stats.droppedEvents += job->eventCount - count;
+}
+
+void updateLiquids() {
+    liquids->tick++;
+
+    // Take the list built up since the last tick
+    int listed = liquids->nextCount;
+    if (listed > LIQUID_MAX_AWAKE_CHUNKS) listed = LIQUID_MAX_AWAKE_CHUNKS;
+    memcpy(liquids->awake, liquids->next, listed * sizeof(ChunkCoord));
+    liquids->awakeCount = listed;
+    liquids->nextCount = 0;
+    liquids->eventCount = 0;
+    liquids->lavaChunkCount = 0;
+    qsort(liquids->awake, liquids->awakeCount, sizeof(ChunkCoord), compareChunkCoords);
+
+    // Promote pending cells everywhere before anything moves, grouping the
+    // chunks by phase. A chunk that was unloaded and recreated can be
+    // listed twice; sorting makes the duplicates adjacent.
+    int count = 0;
+    for (int phase = 0; phase < LIQUID_PHASES; phase++) {
+        liquids->phaseStart[phase] = count;
+        for (int i = 0; i < liquids->awakeCount; i++) {
+            ChunkCoord coord = liquids->awake[i];
+            if (chunkPhase(coord.x, coord.y) != phase) continue;
+            if (i > 0 && compareChunkCoords(&coord, &liquids->awake[i - 1]) == 0) continue;
+            Chunk* chunk = getChunk(coord.x, coord.y);
+            if (!chunk || !chunk->generated) continue;
+
+            memcpy(chunk->liquid.active, chunk->liquid.pending, sizeof(chunk->liquid.active));
+            memset(chunk->liquid.pending, 0, sizeof(chunk->liquid.pending));
+            liquids->processing[count++] = chunk;
+        }
+    }
+    liquids->phaseStart[LIQUID_PHASES] = count;
+
+    for (int phase = 0; phase < LIQUID_PHASES; phase++) {
+        PhaseJobs jobs = {
+            .chunks = liquids->processing + liquids->phaseStart[phase],
+            .count = liquids->phaseStart[phase + 1] - liquids->phaseStart[phase],
+        };
+        int jobCount = (jobs.count + LIQUID_JOB_CHUNKS - 1) / LIQUID_JOB_CHUNKS;
+        runJobs(jobCount, runPhaseJob, &jobs, !liquids->singleThreaded);
+
+        for (int i = 0; i < jobCount; i++) mergeJob(&liquids->jobs[i]);
+    }
+    liquids->stats.awakeChunks = count;
+
+    if (liquids->lavaChunkCount > LIQUID_MAX_AWAKE_CHUNKS) liquids->lavaChunkCount = LIQUID_MAX_AWAKE_CHUNKS;
+    qsort(liquids->lavaChunks, liquids->lavaChunkCount, sizeof(ChunkCoord), compareChunkCoords);
+}
+
+LiquidStats getLiquidStats() {
+    return liquids->stats;
+}
+
+const LiquidEvent* getLiquidEvents(int* count) {
+    *count = liquids->eventCount;
+    return liquids->events;
+}
+
+const ChunkCoord* getLavaChangedChunks(int* count) {
+    *count = liquids->lavaChunkCount;
+    return liquids->lavaChunks;
+}
+
+bool takeLavaChangedCells(Chunk* chunk, uint64_t cells[CHUNK_CELL_WORDS]) {
+    uint64_t any = 0;
+    for (int i = 0; i < CHUNK_CELL_WORDS; i++) {
+        cells[i] = chunk->liquid.lavaCells[i];
+        chunk->liquid.lavaCells[i] = 0;
+        any |= cells[i];
+    }
+    return any != 0;
+}
+
+bool liquidsSettled() {
+    return liquids->nextCount == 0;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "chunk.h"
+
+// Falling liquids (TILE_WATER, TILE_LAVA) on an active set. Only cells
+// whose surroundings changed are looked at: a cell that can't move drops
+// out of its chunk's bitset, and a chunk with no pending cells leaves the
+// awake list entirely, so a tick costs in proportion to moving liquid
+// rather than to the loaded world.
+//
+// Each tick, every awake chunk's pending cells become its active cells
+// before any chunk is processed, so a cell moves at most once per tick.
+// Moves wake the cells that could follow into the vacated one. Unloaded
+// neighbours count as solid.
+//
+// Awake chunks are processed in four phases by the parity of their
+// coordinates (a 2x2 checkerboard), and the chunks of one phase run in
+// parallel on the host's workers. A chunk only updates its own cells, and
+// an update reads and writes tiles at most one tile into a neighbour (the
+// four sides and the diagonals below). Chunks of the same phase have a
+// whole chunk between them, so those one-tile reaches never meet, which
+// is why a 2x2 checkerboard is enough and no move needs a lock. Phases
+// run in a fixed order, so a tick has the same result on any number of
+// threads. What two chunks of a phase can share is a neighbour's
+// bookkeeping (its pending and active bits, version and listing; a
+// reaction wakes cells around the boiled-off water, up to two tiles out),
+// which is updated atomically.
+//
+// Lava and water react where they touch: the lava sets to rock and the
+// water boils off. The check rides along in the cell update, which already
+// reads the neighbours, and each reaction is reported as events. Jobs
+// write events to their own buffers; after each phase the buffers are
+// appended to the tick's list in job order, so consumers (render
+// invalidation, particles, audio) get one deterministic batch per tick.
+// Events can be dropped when a tick has too many; the chunks where lava
+// moved or set, which lighting must revisit, are listed separately and
+// never dropped.
+
+#define LIQUID_MAX_AWAKE_CHUNKS CHUNK_POOL_CAPACITY
+#define LAVA_FLOW_INTERVAL 4 // Lava spreads sideways once every this many ticks
+#define LIQUID_PHASES 4
+#define LIQUID_JOB_CHUNKS 4 // Chunks per job; small enough to balance, big enough to amortize
+#define LIQUID_MAX_JOBS ((LIQUID_MAX_AWAKE_CHUNKS + LIQUID_JOB_CHUNKS - 1) / LIQUID_JOB_CHUNKS)
+#define LIQUID_JOB_EVENTS 64 // Past this a job drops events; the reactions still happen
+#define LIQUID_MAX_EVENTS 4096
+
+typedef struct ChunkCoord
+{
+    int x, y;
+} ChunkCoord;
+
+typedef enum LiquidEventType
+{
+    LIQUID_EVENT_ROCK,  // Lava touched water and set
+    LIQUID_EVENT_STEAM, // Water touched lava and boiled off
+} LiquidEventType;
+
+typedef struct LiquidEvent
+{
+    int x, y; // World tile, x wrapped into the world
+    uint8_t type; // LiquidEventType
+} LiquidEvent;
+
+typedef struct LiquidStats
+{
+    uint64_t cellsUpdated;  // Active cells examined, lifetime
+    uint64_t moves;         // Cells that moved, lifetime
+    uint64_t reactions;     // Lava-water contacts, lifetime
+    uint64_t droppedEvents; // Events that didn't fit a buffer, lifetime
+    int awakeChunks;        // Chunks processed in the last tick
+} LiquidStats;
+
+// What one job did, merged once its phase is over
+typedef struct LiquidJob
+{
+    uint64_t cellsUpdated;
+    uint64_t moves;
+    uint64_t reactions;
+    uint64_t droppedEvents;
+    int eventCount;
+    LiquidEvent events[LIQUID_JOB_EVENTS];
+} LiquidJob;
+
+// Awake lists, allocated once from the host's arena
+typedef struct LiquidState
+{
+    uint64_t tick; // Last tick processed
+    bool singleThreaded; // Run every phase on the calling thread
+    int awakeCount;
+    int nextCount; // Bumped atomically while a phase runs
+    LiquidStats stats;
+    ChunkCoord awake[LIQUID_MAX_AWAKE_CHUNKS]; // Being processed
+    ChunkCoord next[LIQUID_MAX_AWAKE_CHUNKS];  // Listed for the next tick
+    Chunk* processing[LIQUID_MAX_AWAKE_CHUNKS]; // Grouped by phase
+    int phaseStart[LIQUID_PHASES + 1];
+    LiquidJob jobs[LIQUID_MAX_JOBS];
+    int eventCount;
+    LiquidEvent events[LIQUID_MAX_EVENTS]; // The last tick's, in a fixed order
+    int lavaChunkCount; // Bumped atomically while a phase runs
+    ChunkCoord lavaChunks[LIQUID_MAX_AWAKE_CHUNKS]; // The last tick's, sorted
+} LiquidState;
+
+void initLiquids(LiquidState* state);
+void bindLiquids(LiquidState* state);
+
+// Forgets every awake chunk and restarts the tick count. Cell bits in
+// loaded chunks are left alone; callers that rebuild a region clear them.
+void resetLiquids();
+
+// Single-threaded runs give the same results, only slower
+void setLiquidsSingleThreaded(bool singleThreaded);
+
+static inline bool isLiquid(TileType tile) {
+    return tile == TILE_WATER || tile == TILE_LAVA;
+}
+
+// Marks every liquid cell of a freshly generated chunk, and the liquid
+// along its loaded neighbours' facing borders, for the next tick
+void wakeChunkLiquids(Chunk* chunk);
+
+// Marks the liquid cells in a chunk's inclusive local rectangle for the
+// next tick, after an edit changed what they rest on or could flow into.
+// Not to be called while updateLiquids runs.
+void wakeLiquidRegion(Chunk* chunk, int minX, int minY, int maxX, int maxY);
+
+// Runs one tick over the awake chunks
+void updateLiquids();
+
+LiquidStats getLiquidStats();
+
+// Reactions from the last tick, valid until the next updateLiquids
+const LiquidEvent* getLiquidEvents(int* count);
+
+// Chunks where lava moved or set in the last tick, valid until the next
+// updateLiquids. Lava is a light source, so lighting relights these.
+const ChunkCoord* getLavaChangedChunks(int* count);
+
+// Copies out the cells of a chunk where lava moved or set since the last
+// call, as bits laid out like ChunkLiquid's, and clears them. False when
+// there are none. Not to be called while updateLiquids runs.
+bool takeLavaChangedCells(Chunk* chunk, uint64_t cells[CHUNK_CELL_WORDS]);
+
+// True when nothing is listed for the next tick
+bool liquidsSettled();
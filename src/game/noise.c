@@ -0,0 +1,125 @@
+#include "noise.h"
+#include "stb_perlin.h"
+#include <math.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846f
+#endif
+
+typedef struct NoiseBackendImpl
+{
+    const char* name;
+    float (*sample)(float u, float y, int period, uint32_t seed);
+    void (*sampleBatch)(const float* u, const float* y, float* out, int count, int period, uint32_t seed);
+} NoiseBackendImpl;
+
+// --- stb Perlin (reference) ---
+// Wraps by walking a circle through 3D noise, so every sample pays for
+// two trig calls and a full 3D gradient lookup.
+
+static float stbPerlinSample(float u, float y, int period, uint32_t seed) {
+    float radius = (float)period / (2 * PI);
+    float angle = u * 2 * PI;
+    return stb_perlin_noise3_seed(cosf(angle) * radius, y, sinf(angle) * radius, 0, 0, 0, (int)(seed & 0xff));
+}
+
+static void stbPerlinSampleBatch(const float* u, const float* y, float* out, int count, int period, uint32_t seed) {
+    for (int i = 0; i < count; i++) {
+        out[i] = stbPerlinSample(u[i], y[i], period, seed);
+    }
+}
+
+// --- 2D gradient noise with integer hashing ---
+// Wraps by taking the lattice X coordinate modulo the period. No lookup
+// tables and no calls in the inner loop, so the batch version vectorizes.
+
+// Scales the diagonal-gradient output to roughly the same spread as stb's
+// 3D noise so the generation thresholds keep their meaning
+#define GRADIENT2D_SCALE 0.89f
+
+static inline uint32_t hashLattice(int32_t x, int32_t y, uint32_t seed) {
+    uint32_t h = seed ^ ((uint32_t)x * 0x8da6b343u) ^ ((uint32_t)y * 0xd8163841u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline float gradientDot(uint32_t h, float dx, float dy) {
+    return ((h & 1) ? -dx : dx) + ((h & 2) ? -dy : dy);
+}
+
+// floorf without the libm call; truncation plus correction stays in SIMD lanes
+static inline int32_t fastFloor(float v) {
+    int32_t i = (int32_t)v;
+    return i - (v < (float)i);
+}
+
+static inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float gradient2DSample(float u, float y, int period, uint32_t seed) {
+    u -= (float)fastFloor(u);
+    float x = u * (float)period;
+    int32_t x0 = fastFloor(x);
+    int32_t y0 = fastFloor(y);
+    float dx = x - (float)x0;
+    float dy = y - (float)y0;
+
+    x0 = (x0 >= period) ? x0 - period : x0;
+    int32_t x1 = (x0 + 1 >= period) ? 0 : x0 + 1;
+    int32_t y1 = y0 + 1;
+
+    float n00 = gradientDot(hashLattice(x0, y0, seed), dx, dy);
+    float n10 = gradientDot(hashLattice(x1, y0, seed), dx - 1.0f, dy);
+    float n01 = gradientDot(hashLattice(x0, y1, seed), dx, dy - 1.0f);
+    float n11 = gradientDot(hashLattice(x1, y1, seed), dx - 1.0f, dy - 1.0f);
+
+    float sx = fade(dx);
+    float sy = fade(dy);
+    float nx0 = n00 + sx * (n10 - n00);
+    float nx1 = n01 + sx * (n11 - n01);
+    return (nx0 + sy * (nx1 - nx0)) * GRADIENT2D_SCALE;
+}
+
+static float gradient2DSampleScalar(float u, float y, int period, uint32_t seed) {
+    return gradient2DSample(u, y, period, seed);
+}
+
+static void gradient2DSampleBatch(const float* u, const float* y, float* out, int count, int period, uint32_t seed) {
+    for (int i = 0; i < count; i++) {
+        out[i] = gradient2DSample(u[i], y[i], period, seed);
+    }
+}
+
+static const NoiseBackendImpl backends[NOISE_BACKEND_COUNT] = {
+    [NOISE_BACKEND_STB_PERLIN] = {"stb_perlin", stbPerlinSample, stbPerlinSampleBatch},
+    [NOISE_BACKEND_GRADIENT2D] = {"gradient2d", gradient2DSampleScalar, gradient2DSampleBatch},
+};
+
+static NoiseBackend activeBackend = NOISE_BACKEND_GRADIENT2D;
+
+void setNoiseBackend(NoiseBackend backend) {
+    if (backend < 0 || backend >= NOISE_BACKEND_COUNT) return;
+    activeBackend = backend;
+}
+
+NoiseBackend getNoiseBackend() {
+    return activeBackend;
+}
+
+const char* getNoiseBackendName(NoiseBackend backend) {
+    if (backend < 0 || backend >= NOISE_BACKEND_COUNT) return "unknown";
+    return backends[backend].name;
+}
+
+float sampleWrappedNoise(float u, float y, int period, uint32_t seed) {
+    return backends[activeBackend].sample(u, y, period, seed);
+}
+
+void sampleWrappedNoiseBatch(const float* u, const float* y, float* out, int count, int period, uint32_t seed) {
+    backends[activeBackend].sampleBatch(u, y, out, count, period, seed);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Noise backends used by world generation.
+//
+// All samples are "wrapped": u is the horizontal position normalized to
+// [0, 1) around the world and period is the number of noise lattice cells
+// that fit around it, so the result tiles seamlessly at the world seam.
+// y is an unwrapped lattice coordinate. seed selects an independent noise
+// field; the stb backend only honours its low 8 bits.
+
+typedef enum NoiseBackend
+{
+    NOISE_BACKEND_STB_PERLIN, // Reference: stb 3D Perlin sampled on a cylinder
+    NOISE_BACKEND_GRADIENT2D, // 2D gradient noise with integer hashing, no tables
+    NOISE_BACKEND_COUNT
+} NoiseBackend;
+
+void setNoiseBackend(NoiseBackend backend);
+NoiseBackend getNoiseBackend();
+const char* getNoiseBackendName(NoiseBackend backend);
+
+// Single sample, roughly in [-1, 1]
+float sampleWrappedNoise(float u, float y, int period, uint32_t seed);
+
+// Batched samples over SoA inputs: out[i] = noise(u[i], y[i])
+void sampleWrappedNoiseBatch(const float* u, const float* y, float* out, int count, int period, uint32_t seed);
@@ -0,0 +1,318 @@
+#include "noise_graph.h"
+#include "noise.h"
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#define NOISE_NO_MASK 0xff
+
+// Which lane coordinates a node's value depends on
+#define VARIES_COLUMN 1
+#define VARIES_ROW 2
+
+void initNoiseGraph(NoiseGraph* graph) {
+    memset(graph, 0, sizeof(NoiseGraph));
+    graph->output = -1;
+}
+
+static int addNode(NoiseGraph* graph, NoiseNode node) {
+    if (graph->count >= NOISE_GRAPH_MAX_NODES) return -1;
+    graph->nodes[graph->count] = node;
+    // The most recently added node is the output unless told otherwise
+    graph->output = graph->count;
+    return graph->count++;
+}
+
+int noiseConst(NoiseGraph* graph, float value) {
+    return addNode(graph, (NoiseNode){.op = NOISE_OP_CONST, .a = -1, .b = -1, .c = -1, .value = value});
+}
+
+int noiseInput(NoiseGraph* graph, NoiseInput channel) {
+    return addNode(graph, (NoiseNode){.op = NOISE_OP_INPUT, .a = -1, .b = -1, .c = -1, .channel = channel});
+}
+
+int noiseSample(NoiseGraph* graph, int y, int mask, int period, uint32_t seed) {
+    return addNode(graph, (NoiseNode){.op = NOISE_OP_NOISE, .a = y, .b = -1, .c = mask, .period = period, .seed = seed});
+}
+
+int noiseUnary(NoiseGraph* graph, NoiseOp op, int a) {
+    return addNode(graph, (NoiseNode){.op = op, .a = a, .b = -1, .c = -1});
+}
+
+int noiseBinary(NoiseGraph* graph, NoiseOp op, int a, int b) {
+    return addNode(graph, (NoiseNode){.op = op, .a = a, .b = b, .c = -1});
+}
+
+int noiseSelect(NoiseGraph* graph, int condition, int ifTrue, int ifFalse) {
+    return addNode(graph, (NoiseNode){.op = NOISE_OP_SELECT, .a = condition, .b = ifTrue, .c = ifFalse});
+}
+
+// --- Compiler ---
+
+static int operandCount(NoiseOp op) {
+    switch (op) {
+        case NOISE_OP_CONST:
+        case NOISE_OP_INPUT: return 0;
+        case NOISE_OP_NOISE:
+        case NOISE_OP_FLOOR: return 1;
+        case NOISE_OP_SELECT: return 3;
+        default: return 2;
+    }
+}
+
+static float evalScalar(NoiseOp op, float a, float b, float c) {
+    switch (op) {
+        case NOISE_OP_ADD: return a + b;
+        case NOISE_OP_SUB: return a - b;
+        case NOISE_OP_MUL: return a * b;
+        case NOISE_OP_MIN: return fminf(a, b);
+        case NOISE_OP_MAX: return fmaxf(a, b);
+        case NOISE_OP_FLOOR: return floorf(a);
+        case NOISE_OP_GREATER: return a > b ? 1.0f : 0.0f;
+        case NOISE_OP_GREATER_EQUAL: return a >= b ? 1.0f : 0.0f;
+        case NOISE_OP_SELECT: return a != 0.0f ? b : c;
+        default: return 0.0f;
+    }
+}
+
+static int allocReg(bool* regUsed, int first) {
+    for (int r = first; r < NOISE_PROGRAM_MAX_REGS; r++) {
+        if (!regUsed[r]) {
+            regUsed[r] = true;
+            return r;
+        }
+    }
+    return -1;
+}
+
+bool compileNoiseGraph(const NoiseGraph* graph, NoiseProgram* program) {
+    memset(program, 0, sizeof(NoiseProgram));
+
+    int count = graph->count;
+    if (graph->output < 0 || graph->output >= count) return false;
+
+    bool isConst[NOISE_GRAPH_MAX_NODES] = {0};
+    float constValue[NOISE_GRAPH_MAX_NODES] = {0};
+    int varies[NOISE_GRAPH_MAX_NODES] = {0};
+
+    // Validate and fold constants. Operands always precede their users,
+    // so index order is already a topological order.
+    for (int i = 0; i < count; i++) {
+        const NoiseNode* node = &graph->nodes[i];
+        int operands[3] = {node->a, node->b, node->c};
+        int required = operandCount(node->op);
+        bool allConst = true;
+
+        for (int k = 0; k < 3; k++) {
+            bool optional = (node->op == NOISE_OP_NOISE && k == 2);
+            if (k >= required && !optional) continue;
+            if (operands[k] < 0 && optional) continue;
+            if (operands[k] < 0 || operands[k] >= i) {
+                printf("Noise graph: node %d has an invalid operand\n", i);
+                return false;
+            }
+            allConst = allConst && isConst[operands[k]];
+            varies[i] |= varies[operands[k]];
+        }
+
+        if (node->op == NOISE_OP_CONST) {
+            isConst[i] = true;
+            constValue[i] = node->value;
+        } else if (node->op == NOISE_OP_INPUT) {
+            if (node->channel < 0 || node->channel >= NOISE_INPUT_COUNT) return false;
+            varies[i] = (node->channel == NOISE_INPUT_Y) ? VARIES_ROW : VARIES_COLUMN;
+        } else if (node->op == NOISE_OP_NOISE) {
+            varies[i] |= VARIES_COLUMN;
+        } else if (allConst) {
+            isConst[i] = true;
+            constValue[i] = evalScalar(node->op,
+                                       node->a >= 0 ? constValue[node->a] : 0,
+                                       node->b >= 0 ? constValue[node->b] : 0,
+                                       node->c >= 0 ? constValue[node->c] : 0);
+        }
+    }
+
+    // Mark what the output actually needs and where each value dies
+    bool live[NOISE_GRAPH_MAX_NODES] = {0};
+    int lastUse[NOISE_GRAPH_MAX_NODES];
+    for (int i = 0; i < count; i++) lastUse[i] = -1;
+    live[graph->output] = true;
+
+    for (int i = graph->output; i >= 0; i--) {
+        if (!live[i] || isConst[i]) continue;
+        const NoiseNode* node = &graph->nodes[i];
+        int operands[3] = {node->a, node->b, node->c};
+        for (int k = 0; k < 3; k++) {
+            if (operands[k] < 0) continue;
+            live[operands[k]] = true;
+            if (lastUse[operands[k]] < i) lastUse[operands[k]] = i;
+        }
+    }
+
+    // Registers: inputs first, then one per distinct constant, then scratch
+    bool regUsed[NOISE_PROGRAM_MAX_REGS] = {0};
+    int nodeReg[NOISE_GRAPH_MAX_NODES];
+
+    for (int i = 0; i < count; i++) {
+        nodeReg[i] = -1;
+        if (!live[i]) continue;
+
+        if (graph->nodes[i].op == NOISE_OP_INPUT) {
+            nodeReg[i] = graph->nodes[i].channel;
+        } else if (isConst[i]) {
+            int k = 0;
+            while (k < program->constCount && program->constValues[k] != constValue[i]) k++;
+            if (k == program->constCount) {
+                if (k >= NOISE_PROGRAM_MAX_CONSTS) {
+                    printf("Noise graph: too many constants\n");
+                    return false;
+                }
+                program->constValues[k] = constValue[i];
+                for (int lane = 0; lane < NOISE_BATCH_SIZE; lane++) program->constLanes[k][lane] = constValue[i];
+                program->constCount++;
+            }
+            nodeReg[i] = NOISE_INPUT_COUNT + k;
+        }
+    }
+
+    int firstScratch = NOISE_INPUT_COUNT + program->constCount;
+
+    for (int i = 0; i < count; i++) {
+        if (!live[i] || isConst[i] || graph->nodes[i].op == NOISE_OP_INPUT) continue;
+        const NoiseNode* node = &graph->nodes[i];
+        int operands[3] = {node->a, node->b, node->c};
+
+        // The result never shares a register with its operands, which lets
+        // the kernels treat them as non-aliasing
+        nodeReg[i] = allocReg(regUsed, firstScratch);
+        if (nodeReg[i] < 0) {
+            printf("Noise graph: out of registers\n");
+            return false;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            int operand = operands[k];
+            if (operand < 0 || lastUse[operand] != i) continue;
+            if (nodeReg[operand] >= firstScratch) regUsed[nodeReg[operand]] = false;
+        }
+
+        NoiseInstr* instr = &program->code[program->codeCount++];
+        instr->op = (uint8_t)node->op;
+        instr->dst = (uint8_t)nodeReg[i];
+        instr->a = node->a >= 0 ? (uint8_t)nodeReg[node->a] : 0;
+        instr->b = node->b >= 0 ? (uint8_t)nodeReg[node->b] : 0;
+        instr->c = node->c >= 0 ? (uint8_t)nodeReg[node->c] : 0;
+        if (node->op == NOISE_OP_NOISE) {
+            instr->period = node->period;
+            instr->seed = node->seed;
+            // Unmasked noise whose Y doesn't change down a column only needs
+            // one sample per column
+            instr->perColumn = (node->c < 0) && !(varies[node->a] & VARIES_ROW);
+            if (node->c < 0) instr->c = NOISE_NO_MASK;
+        }
+    }
+
+    program->outputReg = (uint8_t)nodeReg[graph->output];
+    program->valid = true;
+    return true;
+}
+
+// --- Executor ---
+
+static void runNoiseInstr(const NoiseInstr* instr, const float* const* src, float* restrict dst) {
+    const float* u = src[NOISE_INPUT_U];
+    const float* y = src[instr->a];
+
+    if (instr->perColumn) {
+        float cu[NOISE_BATCH_COLUMNS], cy[NOISE_BATCH_COLUMNS], cv[NOISE_BATCH_COLUMNS];
+        for (int col = 0; col < NOISE_BATCH_COLUMNS; col++) {
+            cu[col] = u[col * NOISE_BATCH_ROWS];
+            cy[col] = y[col * NOISE_BATCH_ROWS];
+        }
+        sampleWrappedNoiseBatch(cu, cy, cv, NOISE_BATCH_COLUMNS, instr->period, instr->seed);
+        for (int col = 0; col < NOISE_BATCH_COLUMNS; col++) {
+            for (int row = 0; row < NOISE_BATCH_ROWS; row++) {
+                dst[col * NOISE_BATCH_ROWS + row] = cv[col];
+            }
+        }
+        return;
+    }
+
+    if (instr->c == NOISE_NO_MASK) {
+        sampleWrappedNoiseBatch(u, y, dst, NOISE_BATCH_SIZE, instr->period, instr->seed);
+        return;
+    }
+
+    // Masked: compact the active lanes, sample them densely, scatter back
+    const float* mask = src[instr->c];
+    int lanes[NOISE_BATCH_SIZE];
+    int active = 0;
+    for (int i = 0; i < NOISE_BATCH_SIZE; i++) {
+        lanes[active] = i;
+        active += (mask[i] != 0.0f);
+    }
+
+    memset(dst, 0, sizeof(float) * NOISE_BATCH_SIZE);
+    if (active == 0) return;
+
+    float gu[NOISE_BATCH_SIZE], gy[NOISE_BATCH_SIZE], gv[NOISE_BATCH_SIZE];
+    for (int k = 0; k < active; k++) {
+        gu[k] = u[lanes[k]];
+        gy[k] = y[lanes[k]];
+    }
+    sampleWrappedNoiseBatch(gu, gy, gv, active, instr->period, instr->seed);
+    for (int k = 0; k < active; k++) {
+        dst[lanes[k]] = gv[k];
+    }
+}
+
+// Elementwise kernels. Fixed trip count and non-aliasing pointers, so
+// they vectorize.
+#define NOISE_KERNEL(name, expr) \
+    static void name(float* restrict d, const float* restrict a, const float* restrict b, const float* restrict c) { \
+        (void)b; (void)c; \
+        for (int i = 0; i < NOISE_BATCH_SIZE; i++) d[i] = (expr); \
+    }
+
+NOISE_KERNEL(kernelAdd, a[i] + b[i])
+NOISE_KERNEL(kernelSub, a[i] - b[i])
+NOISE_KERNEL(kernelMul, a[i] * b[i])
+NOISE_KERNEL(kernelMin, a[i] < b[i] ? a[i] : b[i])
+NOISE_KERNEL(kernelMax, a[i] > b[i] ? a[i] : b[i])
+NOISE_KERNEL(kernelFloor, floorf(a[i]))
+NOISE_KERNEL(kernelGreater, a[i] > b[i] ? 1.0f : 0.0f)
+NOISE_KERNEL(kernelGreaterEqual, a[i] >= b[i] ? 1.0f : 0.0f)
+NOISE_KERNEL(kernelSelect, a[i] != 0.0f ? b[i] : c[i])
+
+void runNoiseProgram(const NoiseProgram* program, const float* inputs[NOISE_INPUT_COUNT], float* out) {
+    float scratch[NOISE_PROGRAM_MAX_REGS][NOISE_BATCH_SIZE];
+    const float* src[NOISE_PROGRAM_MAX_REGS];
+
+    for (int r = 0; r < NOISE_PROGRAM_MAX_REGS; r++) src[r] = scratch[r];
+    for (int ch = 0; ch < NOISE_INPUT_COUNT; ch++) src[ch] = inputs[ch];
+    for (int k = 0; k < program->constCount; k++) src[NOISE_INPUT_COUNT + k] = program->constLanes[k];
+
+    for (int pc = 0; pc < program->codeCount; pc++) {
+        const NoiseInstr* instr = &program->code[pc];
+        const float* a = src[instr->a];
+        const float* b = src[instr->b];
+        const float* c = src[instr->c < NOISE_PROGRAM_MAX_REGS ? instr->c : 0];
+        float* d = scratch[instr->dst];
+
+        switch ((NoiseOp)instr->op) {
+            case NOISE_OP_NOISE: runNoiseInstr(instr, src, d); break;
+            case NOISE_OP_ADD: kernelAdd(d, a, b, c); break;
+            case NOISE_OP_SUB: kernelSub(d, a, b, c); break;
+            case NOISE_OP_MUL: kernelMul(d, a, b, c); break;
+            case NOISE_OP_MIN: kernelMin(d, a, b, c); break;
+            case NOISE_OP_MAX: kernelMax(d, a, b, c); break;
+            case NOISE_OP_FLOOR: kernelFloor(d, a, b, c); break;
+            case NOISE_OP_GREATER: kernelGreater(d, a, b, c); break;
+            case NOISE_OP_GREATER_EQUAL: kernelGreaterEqual(d, a, b, c); break;
+            case NOISE_OP_SELECT: kernelSelect(d, a, b, c); break;
+            default: break;
+        }
+    }
+
+    memcpy(out, src[program->outputReg], sizeof(float) * NOISE_BATCH_SIZE);
+}
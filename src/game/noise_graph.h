@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Generation layers described as a node graph, compiled to a flat
+// instruction list and run over a whole batch of tiles at once.
+//
+// A batch is NOISE_BATCH_COLUMNS x NOISE_BATCH_ROWS lanes stored column
+// by column (lane = column * NOISE_BATCH_ROWS + row), the same layout as
+// Chunk.tiles, so a chunk is exactly one batch. Every value is a float;
+// comparisons produce 0 or 1.
+
+#define NOISE_BATCH_COLUMNS 16
+#define NOISE_BATCH_ROWS 16
+#define NOISE_BATCH_SIZE (NOISE_BATCH_COLUMNS * NOISE_BATCH_ROWS)
+
+#define NOISE_GRAPH_MAX_NODES 64
+#define NOISE_PROGRAM_MAX_CONSTS 24
+#define NOISE_PROGRAM_MAX_REGS 48
+
+typedef enum NoiseOp
+{
+    NOISE_OP_CONST,         // value
+    NOISE_OP_INPUT,         // per-lane input channel
+    NOISE_OP_NOISE,         // wrapped noise at (u, a), only where c != 0 when c is given
+    NOISE_OP_ADD,           // a + b
+    NOISE_OP_SUB,           // a - b
+    NOISE_OP_MUL,           // a * b
+    NOISE_OP_MIN,           // min(a, b)
+    NOISE_OP_MAX,           // max(a, b)
+    NOISE_OP_FLOOR,         // floor(a)
+    NOISE_OP_GREATER,       // a > b
+    NOISE_OP_GREATER_EQUAL, // a >= b
+    NOISE_OP_SELECT,        // a != 0 ? b : c
+} NoiseOp;
+
+typedef enum NoiseInput
+{
+    NOISE_INPUT_U, // Horizontal position normalized to [0, 1) around the world
+    NOISE_INPUT_Y, // World tile row
+
+    // Biome parameters, constant down a column
+    NOISE_INPUT_SURFACE_LEVEL,
+    NOISE_INPUT_SURFACE_AMPLITUDE,
+    NOISE_INPUT_CAVE_THRESHOLD,
+    NOISE_INPUT_LIQUID_THRESHOLD,
+    NOISE_INPUT_LAVA,
+
+    NOISE_INPUT_COUNT
+} NoiseInput;
+
+typedef struct NoiseNode
+{
+    NoiseOp op;
+    int a, b, c;   // Operand node indices, -1 when unused
+    float value;   // NOISE_OP_CONST
+    int channel;   // NOISE_OP_INPUT
+    int period;    // NOISE_OP_NOISE
+    uint32_t seed; // NOISE_OP_NOISE
+} NoiseNode;
+
+typedef struct NoiseGraph
+{
+    NoiseNode nodes[NOISE_GRAPH_MAX_NODES];
+    int count;
+    int output;
+} NoiseGraph;
+
+typedef struct NoiseInstr
+{
+    uint8_t op;
+    uint8_t dst, a, b, c;
+    bool perColumn; // NOISE: operand is the same down a column, sample once per column
+    int period;
+    uint32_t seed;
+} NoiseInstr;
+
+// Registers are numbered inputs first, then constants, then scratch.
+// Constants are splatted once at compile time so a run never fills them.
+typedef struct NoiseProgram
+{
+    NoiseInstr code[NOISE_GRAPH_MAX_NODES];
+    int codeCount;
+    float constValues[NOISE_PROGRAM_MAX_CONSTS];
+    float constLanes[NOISE_PROGRAM_MAX_CONSTS][NOISE_BATCH_SIZE];
+    int constCount;
+    uint8_t outputReg;
+    bool valid;
+} NoiseProgram;
+
+// Graph building; each returns the new node index, or -1 when the graph is full
+void initNoiseGraph(NoiseGraph* graph);
+int noiseConst(NoiseGraph* graph, float value);
+int noiseInput(NoiseGraph* graph, NoiseInput channel);
+int noiseSample(NoiseGraph* graph, int y, int mask, int period, uint32_t seed);
+int noiseUnary(NoiseGraph* graph, NoiseOp op, int a);
+int noiseBinary(NoiseGraph* graph, NoiseOp op, int a, int b);
+int noiseSelect(NoiseGraph* graph, int condition, int ifTrue, int ifFalse);
+
+// Folds constants, drops nodes the output doesn't reach and assigns
+// registers. Returns false if the graph is malformed or too large.
+bool compileNoiseGraph(const NoiseGraph* graph, NoiseProgram* program);
+
+// Evaluates a batch. inputs holds NOISE_BATCH_SIZE values per channel.
+void runNoiseProgram(const NoiseProgram* program, const float* inputs[NOISE_INPUT_COUNT], float* out);
@@ -0,0 +1,111 @@
+#include "occupancy.h"
+
+void rebuildSolidMask(Chunk* chunk) {
+    uint64_t solid[CHUNK_CELL_WORDS] = {0};
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            int bit = y * CHUNK_SIZE + x;
+            solid[bit >> 6] |= (uint64_t)isSolidTile(chunk->tiles[x][y]) << (bit & 63);
+        }
+    }
+    for (int i = 0; i < CHUNK_CELL_WORDS; i++) chunk->solid[i] = solid[i];
+}
+
+void rebuildSolidRow(Chunk* chunk, int y) {
+    uint64_t row = 0;
+    for (int x = 0; x < CHUNK_SIZE; x++) row |= (uint64_t)isSolidTile(chunk->tiles[x][y]) << x;
+
+    int shift = (y & 3) * CHUNK_SIZE;
+    uint64_t* word = &chunk->solid[y >> 2];
+    *word = (*word & ~(SOLID_ROW_BITS << shift)) | (row << shift);
+}
+
+void updateSolidCell(Chunk* chunk, int x, int y) {
+    int bit = y * CHUNK_SIZE + x;
+    uint64_t mask = 1ull << (bit & 63);
+    if (isSolidTile(chunk->tiles[x][y])) {
+        __atomic_fetch_or(&chunk->solid[bit >> 6], mask, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_and(&chunk->solid[bit >> 6], ~mask, __ATOMIC_RELAXED);
+    }
+}
+
+static inline int floorDiv(int value, int divisor) {
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+bool isSolidAt(int tileX, int tileY) {
+    int chunkX = floorDiv(tileX, CHUNK_SIZE);
+    int chunkY = floorDiv(tileY, CHUNK_SIZE);
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    if (!chunk || !chunk->generated) return false;
+    return isCellSolid(chunk, tileX - chunkX * CHUNK_SIZE, tileY - chunkY * CHUNK_SIZE);
+}
+
+// Bits lo..hi of a row, both in [0, CHUNK_SIZE)
+static inline uint16_t spanBits(int lo, int hi) {
+    return (uint16_t)((SOLID_ROW_BITS >> (CHUNK_SIZE - 1 - (hi - lo))) << lo);
+}
+
+// Chunk by chunk: empty chunks are skipped, full ones answer at once, and
+// the rest test each row of the rectangle with a single AND
+bool isSolidInRect(int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    if (maxTileX < minTileX || maxTileY < minTileY) return false;
+
+    int startChunkX = floorDiv(minTileX, CHUNK_SIZE);
+    int endChunkX = floorDiv(maxTileX, CHUNK_SIZE);
+    int startChunkY = floorDiv(minTileY, CHUNK_SIZE);
+    int endChunkY = floorDiv(maxTileY, CHUNK_SIZE);
+
+    for (int cx = startChunkX; cx <= endChunkX; cx++) {
+        int baseX = cx * CHUNK_SIZE;
+        int loX = (minTileX > baseX) ? minTileX - baseX : 0;
+        int hiX = (maxTileX < baseX + CHUNK_SIZE - 1) ? maxTileX - baseX : CHUNK_SIZE - 1;
+        uint16_t columns = spanBits(loX, hiX);
+
+        for (int cy = startChunkY; cy <= endChunkY; cy++) {
+            Chunk* chunk = getChunk(cx, cy);
+            if (!chunk || !chunk->generated || isChunkSolidEmpty(chunk)) continue;
+            if (isChunkSolidFull(chunk)) return true;
+
+            int baseY = cy * CHUNK_SIZE;
+            int loY = (minTileY > baseY) ? minTileY - baseY : 0;
+            int hiY = (maxTileY < baseY + CHUNK_SIZE - 1) ? maxTileY - baseY : CHUNK_SIZE - 1;
+            for (int y = loY; y <= hiY; y++) {
+                if (getSolidRow(chunk, y) & columns) return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool findSolidInRow(int tileY, int fromX, int toX, int* hitX) {
+    int chunkY = floorDiv(tileY, CHUNK_SIZE);
+    int y = tileY - chunkY * CHUNK_SIZE;
+    int step = (toX >= fromX) ? 1 : -1;
+
+    // One chunk-wide slice of the span per iteration
+    int x = fromX;
+    for (;;) {
+        int chunkX = floorDiv(x, CHUNK_SIZE);
+        int baseX = chunkX * CHUNK_SIZE;
+        int sliceEnd = (step > 0) ? baseX + CHUNK_SIZE - 1 : baseX;
+        bool last = (step > 0) ? toX <= sliceEnd : toX >= sliceEnd;
+        if (last) sliceEnd = toX;
+
+        Chunk* chunk = getChunk(chunkX, chunkY);
+        if (chunk && chunk->generated) {
+            int lo = ((step > 0) ? x : sliceEnd) - baseX;
+            int hi = ((step > 0) ? sliceEnd : x) - baseX;
+            uint16_t hits = getSolidRow(chunk, y) & spanBits(lo, hi);
+            if (hits) {
+                // Nearest to the start: lowest bit going right, highest going left
+                *hitX = baseX + ((step > 0) ? __builtin_ctz(hits) : 31 - __builtin_clz(hits));
+                return true;
+            }
+        }
+
+        if (last) return false;
+        x = sliceEnd + step;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "chunk.h"
+
+// Which tiles are solid, kept per chunk as a 256-bit mask (Chunk.solid).
+// Bit y * CHUNK_SIZE + x is tile (x, y), so each word packs four rows of
+// sixteen and a row is one 16-bit field. Collision, raycasts and paths
+// only need solidity, and a mask answers a whole row or rectangle with a
+// few bit operations instead of a tile read and compare per cell. An
+// all-clear or all-set mask lets a query skip the chunk outright.
+//
+// The mask is rebuilt when a chunk is generated and kept up to date by
+// everything that writes tiles afterwards. Unloaded chunks read as empty,
+// like getTileAt.
+
+#define SOLID_ROW_BITS 0xffffull
+
+static inline bool isSolidTile(TileType tile) {
+    return tile == TILE_DIRT || tile == TILE_ROCK;
+}
+
+static inline bool isCellSolid(const Chunk* chunk, int x, int y) {
+    int bit = y * CHUNK_SIZE + x;
+    return (chunk->solid[bit >> 6] >> (bit & 63)) & 1;
+}
+
+// Bit x is tile (x, y)
+static inline uint16_t getSolidRow(const Chunk* chunk, int y) {
+    return (uint16_t)(chunk->solid[y >> 2] >> ((y & 3) * CHUNK_SIZE));
+}
+
+static inline bool isChunkSolidEmpty(const Chunk* chunk) {
+    return (chunk->solid[0] | chunk->solid[1] | chunk->solid[2] | chunk->solid[3]) == 0;
+}
+
+static inline bool isChunkSolidFull(const Chunk* chunk) {
+    return (chunk->solid[0] & chunk->solid[1] & chunk->solid[2] & chunk->solid[3]) == ~0ull;
+}
+
+// Recomputes the whole mask from the tiles, after generation or a bulk write
+void rebuildSolidMask(Chunk* chunk);
+
+// Recomputes row y's bits from its tiles, after an edit wrote across it
+void rebuildSolidRow(Chunk* chunk, int y);
+
+// Keeps one cell's bit in step with a tile just written. Atomic, so liquid
+// jobs on different threads can update a shared neighbour.
+void updateSolidCell(Chunk* chunk, int x, int y);
+
+// World tile queries. X wraps around the world; Y is unbounded.
+bool isSolidAt(int tileX, int tileY);
+
+// True if any tile in the inclusive rectangle is solid
+bool isSolidInRect(int minTileX, int minTileY, int maxTileX, int maxTileY);
+
+// First solid tile along row tileY walking from fromX to toX (either
+// direction, inclusive). Returns false when the span is clear.
+bool findSolidInRow(int tileY, int fromX, int toX, int* hitX);
@@ -0,0 +1,430 @@
+#include "pathfind.h"
+#include "occupancy.h"
+#include <stdlib.h>
+#include <string.h>
+
+static PathfindState* paths = NULL;
+
+enum { SIDE_LEFT, SIDE_RIGHT, SIDE_UP, SIDE_DOWN, SIDE_COUNT };
+static const int sideX[SIDE_COUNT] = {-1, 1, 0, 0};
+static const int sideY[SIDE_COUNT] = {0, 0, -1, 1};
+static const int oppositeSide[SIDE_COUNT] = {SIDE_RIGHT, SIDE_LEFT, SIDE_DOWN, SIDE_UP};
+
+// The start and goal are fixed nodes outside the (chunk, portal) table
+#define START_NODE 0
+#define GOAL_NODE 1
+#define TABLE_SIZE (2 * NAV_MAX_SEARCH_NODES)
+#define UNREACHED 0xffff
+
+void initPathfind(PathfindState* state) {
+    paths = state;
+    state->query = 0;
+    state->nodeCount = 0;
+    memset(&state->stats, 0, sizeof(state->stats));
+    memset(state->table, 0xff, sizeof(state->table));
+}
+
+void bindPathfind(PathfindState* state) {
+    paths = state;
+}
+
+static inline int floorDiv(int value, int divisor) {
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static Chunk* getNavChunk(int chunkX, int chunkY) {
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    return (chunk && chunk->generated) ? chunk : NULL;
+}
+
+// Open cells along a side, bit i at offset i (x for rows, y for columns)
+static uint16_t openBorder(const Chunk* chunk, int side) {
+    if (side == SIDE_UP) return (uint16_t)~getSolidRow(chunk, 0);
+    if (side == SIDE_DOWN) return (uint16_t)~getSolidRow(chunk, CHUNK_SIZE - 1);
+
+    int x = (side == SIDE_LEFT) ? 0 : CHUNK_SIZE - 1;
+    uint16_t open = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        if (!isCellSolid(chunk, x, y)) open |= (uint16_t)(1u << y);
+    }
+    return open;
+}
+
+// What the neighbour across a side leaves open facing it; nothing when unloaded
+static uint16_t facingBorder(const Chunk* chunk, int side) {
+    Chunk* neighbor = getNavChunk(chunk->x + sideX[side], chunk->y + sideY[side]);
+    return neighbor ? openBorder(neighbor, oppositeSide[side]) : 0;
+}
+
+static inline int sideCell(int side, int offset) {
+    switch (side) {
+        case SIDE_LEFT: return offset * CHUNK_SIZE;
+        case SIDE_RIGHT: return offset * CHUNK_SIZE + CHUNK_SIZE - 1;
+        case SIDE_UP: return offset;
+        default: return (CHUNK_SIZE - 1) * CHUNK_SIZE + offset;
+    }
+}
+
+static inline int sideOffset(int side, int cell) {
+    return (side == SIDE_LEFT || side == SIDE_RIGHT) ? cell / CHUNK_SIZE : cell % CHUNK_SIZE;
+}
+
+// Breadth-first over the chunk's open cells (index y * CHUNK_SIZE + x).
+// toward, when given, gets each cell's next step back to fromCell; the
+// flood stops early once it reaches untilCell (-1 to flood everything).
+static void floodChunk(const Chunk* chunk, int fromCell, uint16_t distance[CHUNK_SIZE * CHUNK_SIZE],
+                       uint8_t* toward, int untilCell) {
+    uint8_t queue[CHUNK_SIZE * CHUNK_SIZE];
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++) distance[i] = UNREACHED;
+
+    int head = 0, tail = 0;
+    distance[fromCell] = 0;
+    queue[tail++] = (uint8_t)fromCell;
+    while (head < tail) {
+        int cell = queue[head++];
+        if (cell == untilCell) return;
+        int x = cell % CHUNK_SIZE, y = cell / CHUNK_SIZE;
+        for (int side = 0; side < SIDE_COUNT; side++) {
+            int nx = x + sideX[side], ny = y + sideY[side];
+            if (nx < 0 || nx >= CHUNK_SIZE || ny < 0 || ny >= CHUNK_SIZE) continue;
+            int next = ny * CHUNK_SIZE + nx;
+            if (distance[next] != UNREACHED || isCellSolid(chunk, nx, ny)) continue;
+            distance[next] = distance[cell] + 1;
+            if (toward) toward[next] = (uint8_t)cell;
+            queue[tail++] = (uint8_t)next;
+        }
+    }
+}
+
+static void buildChunkNav(Chunk* chunk, const uint16_t facing[SIDE_COUNT]) {
+    ChunkNav* nav = &chunk->nav;
+    nav->portalCount = 0;
+    memset(nav->sidePortals, NAV_NONE, sizeof(nav->sidePortals));
+
+    for (int side = 0; side < SIDE_COUNT; side++) {
+        uint16_t open = openBorder(chunk, side) & facing[side];
+        int offset = 0;
+        while (offset < CHUNK_SIZE) {
+            if (!((open >> offset) & 1)) {
+                offset++;
+                continue;
+            }
+            int end = offset;
+            while (end + 1 < CHUNK_SIZE && ((open >> (end + 1)) & 1)) end++;
+
+            int middle = (offset + end) / 2;
+            int portal = nav->portalCount++;
+            nav->portalCell[portal] = (uint8_t)sideCell(side, middle);
+            nav->portalSide[portal] = (uint8_t)side;
+            nav->sidePortals[side][middle] = (uint8_t)portal;
+            offset = end + 1;
+        }
+    }
+
+    uint16_t distance[CHUNK_SIZE * CHUNK_SIZE];
+    for (int from = 0; from < nav->portalCount; from++) {
+        floodChunk(chunk, nav->portalCell[from], distance, NULL, -1);
+        for (int to = 0; to < nav->portalCount; to++) {
+            uint16_t steps = distance[nav->portalCell[to]];
+            nav->distance[from][to] = (steps >= NAV_NONE) ? NAV_NONE : (uint8_t)steps;
+        }
+    }
+
+    memcpy(nav->solid, chunk->solid, sizeof(nav->solid));
+    memcpy(nav->facing, facing, sizeof(nav->facing));
+    nav->built = true;
+    paths->stats.chunksRebuilt++;
+}
+
+// The chunk's graph, rebuilt first if its tiles or a neighbour's facing
+// border changed since. Checked once per query.
+static const ChunkNav* getChunkNav(Chunk* chunk) {
+    ChunkNav* nav = &chunk->nav;
+    if (nav->built && nav->checkedQuery == paths->query) return nav;
+
+    uint16_t facing[SIDE_COUNT];
+    for (int side = 0; side < SIDE_COUNT; side++) facing[side] = facingBorder(chunk, side);
+    if (!nav->built || memcmp(nav->solid, chunk->solid, sizeof(nav->solid)) != 0 ||
+        memcmp(nav->facing, facing, sizeof(facing)) != 0) {
+        buildChunkNav(chunk, facing);
+    }
+    nav->checkedQuery = paths->query;
+    return nav;
+}
+
+// --- Open set: a binary min-heap on estimate, with positions kept in the nodes ---
+
+static void heapSwap(int a, int b) {
+    int nodeA = paths->heap[a], nodeB = paths->heap[b];
+    paths->heap[a] = nodeB;
+    paths->heap[b] = nodeA;
+    paths->nodes[nodeB].heapIndex = a;
+    paths->nodes[nodeA].heapIndex = b;
+}
+
+static void heapUp(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (paths->nodes[paths->heap[parent]].estimate <= paths->nodes[paths->heap[index]].estimate) break;
+        heapSwap(index, parent);
+        index = parent;
+    }
+}
+
+static void heapDown(int index) {
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1, right = left + 1;
+        if (left < paths->heapCount &&
+            paths->nodes[paths->heap[left]].estimate < paths->nodes[paths->heap[smallest]].estimate) smallest = left;
+        if (right < paths->heapCount &&
+            paths->nodes[paths->heap[right]].estimate < paths->nodes[paths->heap[smallest]].estimate) smallest = right;
+        if (smallest == index) return;
+        heapSwap(index, smallest);
+        index = smallest;
+    }
+}
+
+static int heapPop() {
+    int node = paths->heap[0];
+    paths->heapCount--;
+    if (paths->heapCount > 0) {
+        paths->heap[0] = paths->heap[paths->heapCount];
+        paths->nodes[paths->heap[0]].heapIndex = 0;
+        heapDown(0);
+    }
+    paths->nodes[node].heapIndex = -1;
+    return node;
+}
+
+// --- Search ---
+
+typedef struct SearchGoal
+{
+    Chunk* chunk;
+    int tileX, tileY; // Wrapped X
+    int cell;
+    uint16_t distance[CHUNK_SIZE * CHUNK_SIZE]; // From every cell of its chunk
+} SearchGoal;
+
+static inline unsigned int hashNodeKey(const Chunk* chunk, int portal) {
+    uintptr_t key = ((uintptr_t)chunk >> 6) * CHUNK_NAV_PORTALS + (uintptr_t)portal;
+    return (unsigned int)(key * 2654435761u) & (TABLE_SIZE - 1);
+}
+
+// Index of the node for (chunk, portal), added unreached if new; -1 when full
+static int findNode(Chunk* chunk, int portal) {
+    unsigned int slot = hashNodeKey(chunk, portal);
+    for (;;) {
+        int index = paths->table[slot];
+        if (index < 0) break;
+        if (paths->nodes[index].chunk == chunk && paths->nodes[index].portal == portal) return index;
+        slot = (slot + 1) & (TABLE_SIZE - 1);
+    }
+
+    if (paths->nodeCount == NAV_MAX_SEARCH_NODES) return -1;
+    int index = paths->nodeCount++;
+    paths->nodes[index] = (NavSearchNode){
+        .chunk = chunk, .cost = -1, .parent = -1, .heapIndex = -1, .tableSlot = (int)slot, .portal = (uint8_t)portal,
+    };
+    paths->table[slot] = index;
+    return index;
+}
+
+// Manhattan distance to the goal, the short way around the world
+static int estimateToGoal(const SearchGoal* goal, int tileX, int tileY) {
+    int dx = abs(goal->tileX - tileX) % WORLD_WIDTH_TILES;
+    if (dx > WORLD_WIDTH_TILES - dx) dx = WORLD_WIDTH_TILES - dx;
+    return dx + abs(goal->tileY - tileY);
+}
+
+static inline int nodeTileX(const NavSearchNode* node, int cell) {
+    return node->chunkX * CHUNK_SIZE + cell % CHUNK_SIZE;
+}
+
+static inline int nodeTileY(const NavSearchNode* node, int cell) {
+    return node->chunkY * CHUNK_SIZE + cell / CHUNK_SIZE;
+}
+
+// Offers a node a cheaper way in from `from`. The node's chunk sits at
+// (chunkX, chunkY), unwrapped.
+static void relax(int from, int index, int chunkX, int chunkY, int steps, const SearchGoal* goal, int cell) {
+    NavSearchNode* node = &paths->nodes[index];
+    int cost = paths->nodes[from].cost + steps;
+    if (node->closed || (node->cost >= 0 && node->cost <= cost)) return;
+
+    node->cost = cost;
+    node->parent = from;
+    node->chunkX = chunkX;
+    node->chunkY = chunkY;
+    node->estimate = cost + estimateToGoal(goal, wrapChunkX(chunkX) * CHUNK_SIZE + cell % CHUNK_SIZE,
+                                           chunkY * CHUNK_SIZE + cell / CHUNK_SIZE);
+    if (node->heapIndex < 0) {
+        node->heapIndex = paths->heapCount;
+        paths->heap[paths->heapCount++] = index;
+    }
+    heapUp(node->heapIndex);
+}
+
+// Edges out of a portal node: to the other portals of its chunk, across
+// the border to its partner, and to the goal if this is the goal's chunk
+static bool expandPortal(int index, const SearchGoal* goal) {
+    NavSearchNode node = paths->nodes[index];
+    const ChunkNav* nav = getChunkNav(node.chunk);
+
+    for (int to = 0; to < nav->portalCount; to++) {
+        uint8_t steps = nav->distance[node.portal][to];
+        if (to == node.portal || steps == NAV_NONE) continue;
+        int next = findNode(node.chunk, to);
+        if (next < 0) return false;
+        relax(index, next, node.chunkX, node.chunkY, steps, goal, nav->portalCell[to]);
+    }
+
+    int cell = nav->portalCell[node.portal];
+    if (node.chunk == goal->chunk && goal->distance[cell] != UNREACHED) {
+        relax(index, GOAL_NODE, node.chunkX, node.chunkY, goal->distance[cell], goal, goal->cell);
+    }
+
+    int side = nav->portalSide[node.portal];
+    int offset = sideOffset(side, cell);
+    int neighborX = node.chunkX + sideX[side], neighborY = node.chunkY + sideY[side];
+    Chunk* neighbor = getNavChunk(neighborX, neighborY);
+    if (!neighbor) return true;
+    const ChunkNav* neighborNav = getChunkNav(neighbor);
+    uint8_t partner = neighborNav->sidePortals[oppositeSide[side]][offset];
+    if (partner == NAV_NONE) return true;
+
+    int next = findNode(neighbor, partner);
+    if (next < 0) return false;
+    relax(index, next, neighborX, neighborY, 1, goal, neighborNav->portalCell[partner]);
+    return true;
+}
+
+// Appends the walk inside one chunk from one cell to another, excluding
+// the first cell
+static void appendLocalPath(NavPath* path, const Chunk* chunk, int chunkX, int chunkY, int fromCell, int toCell) {
+    uint16_t distance[CHUNK_SIZE * CHUNK_SIZE];
+    uint8_t toward[CHUNK_SIZE * CHUNK_SIZE];
+    floodChunk(chunk, toCell, distance, toward, fromCell);
+
+    for (int cell = fromCell; cell != toCell;) {
+        cell = toward[cell];
+        if (path->length == NAV_MAX_PATH_POINTS) {
+            path->truncated = true;
+            return;
+        }
+        path->points[path->length++] = (NavPoint){chunkX * CHUNK_SIZE + cell % CHUNK_SIZE,
+                                                  chunkY * CHUNK_SIZE + cell / CHUNK_SIZE};
+    }
+}
+
+static void appendPoint(NavPath* path, int x, int y) {
+    if (path->length == NAV_MAX_PATH_POINTS) {
+        path->truncated = true;
+        return;
+    }
+    path->points[path->length++] = (NavPoint){x, y};
+}
+
+// Walks the parents back from the goal, then refines each hop into tiles
+static void buildPath(NavPath* path, int startCell, int goalCell) {
+    static int route[NAV_MAX_SEARCH_NODES];
+    int count = 0;
+    for (int index = GOAL_NODE; index >= 0; index = paths->nodes[index].parent) route[count++] = index;
+
+    const NavSearchNode* start = &paths->nodes[START_NODE];
+    path->length = 0;
+    path->truncated = false;
+    appendPoint(path, nodeTileX(start, startCell), nodeTileY(start, startCell));
+
+    int cell = startCell;
+    for (int i = count - 2; i >= 0; i--) {
+        const NavSearchNode* prev = &paths->nodes[route[i + 1]];
+        const NavSearchNode* node = &paths->nodes[route[i]];
+        int nextCell = (node->portal != NAV_NONE) ? node->chunk->nav.portalCell[node->portal] : goalCell;
+        if (node->chunkX == prev->chunkX && node->chunkY == prev->chunkY) {
+            appendLocalPath(path, node->chunk, node->chunkX, node->chunkY, cell, nextCell);
+        } else {
+            appendPoint(path, nodeTileX(node, nextCell), nodeTileY(node, nextCell));
+        }
+        cell = nextCell;
+    }
+    path->cost = paths->nodes[GOAL_NODE].cost;
+}
+
+bool findPath(int startTileX, int startTileY, int goalTileX, int goalTileY, NavPath* path) {
+    static SearchGoal goal;
+    paths->query++;
+    paths->stats.queries++;
+    path->length = 0;
+    path->cost = 0;
+    path->truncated = false;
+
+    int startChunkX = floorDiv(startTileX, CHUNK_SIZE), startChunkY = floorDiv(startTileY, CHUNK_SIZE);
+    int goalChunkX = floorDiv(goalTileX, CHUNK_SIZE), goalChunkY = floorDiv(goalTileY, CHUNK_SIZE);
+    Chunk* startChunk = getNavChunk(startChunkX, startChunkY);
+    Chunk* goalChunk = getNavChunk(goalChunkX, goalChunkY);
+    if (!startChunk || !goalChunk) return false;
+
+    int startCell = (startTileY - startChunkY * CHUNK_SIZE) * CHUNK_SIZE + (startTileX - startChunkX * CHUNK_SIZE);
+    int goalCell = (goalTileY - goalChunkY * CHUNK_SIZE) * CHUNK_SIZE + (goalTileX - goalChunkX * CHUNK_SIZE);
+    if (isCellSolid(startChunk, startCell % CHUNK_SIZE, startCell / CHUNK_SIZE) ||
+        isCellSolid(goalChunk, goalCell % CHUNK_SIZE, goalCell / CHUNK_SIZE)) return false;
+
+    goal.chunk = goalChunk;
+    goal.tileX = wrapChunkX(goalChunkX) * CHUNK_SIZE + goalCell % CHUNK_SIZE;
+    goal.tileY = goalTileY;
+    goal.cell = goalCell;
+    floodChunk(goalChunk, goalCell, goal.distance, NULL, -1);
+
+    // Clearing just the last query's slots beats clearing the whole table
+    for (int i = 2; i < paths->nodeCount; i++) paths->table[paths->nodes[i].tableSlot] = -1;
+    paths->nodeCount = 2;
+    paths->heapCount = 0;
+    paths->nodes[START_NODE] = (NavSearchNode){
+        .chunk = startChunk, .chunkX = startChunkX, .chunkY = startChunkY,
+        .cost = 0, .parent = -1, .heapIndex = -1, .portal = NAV_NONE,
+    };
+    paths->nodes[GOAL_NODE] = (NavSearchNode){
+        .chunk = goalChunk, .cost = -1, .parent = -1, .heapIndex = -1, .portal = NAV_NONE,
+    };
+
+    // The start's edges: its chunk's portals, and the goal when it is in
+    // the same chunk
+    const ChunkNav* startNav = getChunkNav(startChunk);
+    uint16_t startDistance[CHUNK_SIZE * CHUNK_SIZE];
+    floodChunk(startChunk, startCell, startDistance, NULL, -1);
+    paths->nodes[START_NODE].closed = true;
+    if (startChunk == goalChunk && startDistance[goalCell] != UNREACHED) {
+        relax(START_NODE, GOAL_NODE, startChunkX, startChunkY, startDistance[goalCell], &goal, goalCell);
+    }
+    for (int portal = 0; portal < startNav->portalCount; portal++) {
+        uint16_t steps = startDistance[startNav->portalCell[portal]];
+        if (steps == UNREACHED) continue;
+        int next = findNode(startChunk, portal);
+        relax(START_NODE, next, startChunkX, startChunkY, steps, &goal, startNav->portalCell[portal]);
+    }
+
+    bool overflow = false;
+    while (paths->heapCount > 0) {
+        int index = heapPop();
+        if (index == GOAL_NODE) break;
+        paths->nodes[index].closed = true;
+        paths->stats.nodesExpanded++;
+        if (!expandPortal(index, &goal)) {
+            overflow = true;
+            break;
+        }
+    }
+
+    if (overflow) paths->stats.searchOverflows++;
+    if (overflow || paths->nodes[GOAL_NODE].cost < 0 || paths->nodes[GOAL_NODE].heapIndex >= 0) return false;
+
+    buildPath(path, startCell, goalCell);
+    paths->stats.found++;
+    return true;
+}
+
+PathStats getPathStats() {
+    return paths->stats;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "chunk.h"
+
+// Hierarchical pathfinding (HPA*) for agents that fit in one tile and move
+// between 4-connected open (non-solid) tiles.
+//
+// Every run of open cells along a chunk border whose facing cells in the
+// neighbour are open too gets one portal, at the middle of the run, so
+// each chunk has at most CHUNK_NAV_PORTALS. A chunk caches the walking
+// distance between each pair of its portals (ChunkNav); together with a
+// step of cost 1 from each portal to its partner across the border, that
+// is the abstract graph a query searches with A*. Starting and goal cells
+// are linked in with a flood over their own chunk, and the abstract path
+// is refined into tiles one chunk at a time at the end.
+//
+// The graph is repaired lazily: a chunk's cache records the solid mask and
+// the neighbours' facing borders it was built from, and a query rebuilds
+// it when they differ. So an edit that changes solidity rebuilds only that
+// chunk and those whose shared border changed, a load or unload only the
+// neighbours on that side, and liquids moving (which never change
+// solidity) rebuild nothing. Unloaded chunks are closed.
+
+#define NAV_NONE 0xff
+#define NAV_MAX_SEARCH_NODES 32768 // Abstract nodes one query may reach
+#define NAV_MAX_PATH_POINTS 8192
+
+typedef struct NavPoint
+{
+    int x, y; // World tile, unwrapped: consecutive points are always adjacent
+} NavPoint;
+
+typedef struct NavPath
+{
+    int length;   // Points, the start and goal included
+    int cost;     // Steps; length - 1 unless truncated
+    bool truncated; // Longer than NAV_MAX_PATH_POINTS; the points stop short
+    NavPoint points[NAV_MAX_PATH_POINTS];
+} NavPath;
+
+typedef struct PathStats
+{
+    uint64_t queries;
+    uint64_t found;
+    uint64_t chunksRebuilt;  // Chunk graphs (re)built, lifetime
+    uint64_t nodesExpanded;  // Abstract nodes, lifetime
+    uint64_t searchOverflows; // Queries that gave up at NAV_MAX_SEARCH_NODES
+} PathStats;
+
+// One abstract node reached by a search. Chunk coordinates are unwrapped
+// relative to the start, so a path can cross the world seam.
+typedef struct NavSearchNode
+{
+    Chunk* chunk;
+    int chunkX, chunkY;
+    int cost;     // From the start
+    int estimate; // cost plus the heuristic
+    int parent;   // Node index, -1 for the start
+    int heapIndex; // Position in the open heap, -1 when not in it
+    int tableSlot; // Where the node is in PathfindState.table
+    uint8_t portal; // NAV_NONE for the start and goal nodes
+    bool closed;
+} NavSearchNode;
+
+// Search scratch, allocated once from the host's arena
+typedef struct PathfindState
+{
+    uint64_t query;
+    PathStats stats;
+    int nodeCount;
+    NavSearchNode nodes[NAV_MAX_SEARCH_NODES];
+    int heapCount;
+    int heap[NAV_MAX_SEARCH_NODES]; // Open node indices, a binary min-heap on estimate
+    int table[2 * NAV_MAX_SEARCH_NODES]; // (chunk, portal) to node index, open addressing, -1 empty
+} PathfindState;
+
+void initPathfind(PathfindState* state);
+void bindPathfind(PathfindState* state);
+
+// Shortest path (within a few percent; HPA* routes through portals) from
+// one open tile to another. X wraps; the points follow from startTileX
+// unwrapped. False when either end is solid or unloaded, or no path exists
+// through loaded chunks.
+bool findPath(int startTileX, int startTileY, int goalTileX, int goalTileY, NavPath* path);
+
+PathStats getPathStats();
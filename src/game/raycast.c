@@ -0,0 +1,146 @@
+#include "raycast.h"
+#include "occupancy.h"
+#include <math.h>
+#include <string.h>
+
+// Direct-mapped chunk lookups shared by the rays of a batch. Misses
+// (unloaded chunks) are cached too.
+#define RAY_CHUNK_CACHE_SIZE 64
+
+typedef struct RayChunkCache
+{
+    int x[RAY_CHUNK_CACHE_SIZE];
+    int y[RAY_CHUNK_CACHE_SIZE];
+    Chunk* chunk[RAY_CHUNK_CACHE_SIZE];
+    bool valid[RAY_CHUNK_CACHE_SIZE];
+} RayChunkCache;
+
+static Chunk* lookupChunk(RayChunkCache* cache, int chunkX, int chunkY) {
+    chunkX = wrapChunkX(chunkX);
+    int slot = (unsigned)(chunkX * 7 + chunkY * 31) & (RAY_CHUNK_CACHE_SIZE - 1);
+    if (cache->valid[slot] && cache->x[slot] == chunkX && cache->y[slot] == chunkY) return cache->chunk[slot];
+
+    Chunk* chunk = getChunk(chunkX, chunkY);
+    if (chunk && !chunk->generated) chunk = NULL;
+    cache->x[slot] = chunkX;
+    cache->y[slot] = chunkY;
+    cache->chunk[slot] = chunk;
+    cache->valid[slot] = true;
+    return chunk;
+}
+
+static inline int floorDiv(int value, int divisor) {
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Amanatides-Woo in tile units. t is the distance along the normalized
+// direction, also in tiles; tMaxX/tMaxY are recomputed from the origin
+// whenever the walk jumps, so skipping chunks doesn't accumulate error.
+static bool castWithCache(RayChunkCache* cache, TileRay ray, TileRayHit* hit) {
+    memset(hit, 0, sizeof(*hit));
+
+    float length = sqrtf(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y);
+    if (length == 0.0f) return false;
+    float dirX = ray.direction.x / length;
+    float dirY = ray.direction.y / length;
+
+    float originX = ray.origin.x / TILE_SIZE;
+    float originY = ray.origin.y / TILE_SIZE;
+    float maxT = ray.maxDistance / TILE_SIZE;
+
+    int stepX = (dirX > 0) ? 1 : -1;
+    int stepY = (dirY > 0) ? 1 : -1;
+    float deltaX = (dirX != 0.0f) ? fabsf(1.0f / dirX) : INFINITY;
+    float deltaY = (dirY != 0.0f) ? fabsf(1.0f / dirY) : INFINITY;
+
+    int tileX = (int)floorf(originX);
+    int tileY = (int)floorf(originY);
+    float t = 0.0f;
+    int normalX = 0, normalY = 0;
+
+    while (t <= maxT) {
+        int chunkX = floorDiv(tileX, CHUNK_SIZE);
+        int chunkY = floorDiv(tileY, CHUNK_SIZE);
+        Chunk* chunk = lookupChunk(cache, chunkX, chunkY);
+
+        float tMaxX = (dirX != 0.0f) ? (tileX + (stepX > 0) - originX) / dirX : INFINITY;
+        float tMaxY = (dirY != 0.0f) ? (tileY + (stepY > 0) - originY) / dirY : INFINITY;
+
+        if (!chunk || isChunkSolidEmpty(chunk)) {
+            // Jump to where the ray leaves this chunk
+            int edgeX = (chunkX + (stepX > 0)) * CHUNK_SIZE;
+            int edgeY = (chunkY + (stepY > 0)) * CHUNK_SIZE;
+            float exitX = (dirX != 0.0f) ? (edgeX - originX) / dirX : INFINITY;
+            float exitY = (dirY != 0.0f) ? (edgeY - originY) / dirY : INFINITY;
+
+            if (exitX < exitY) {
+                t = exitX;
+                tileX = edgeX - (stepX < 0);
+                tileY = (int)floorf(originY + dirY * t);
+                normalX = -stepX, normalY = 0;
+            } else {
+                t = exitY;
+                tileY = edgeY - (stepY < 0);
+                tileX = (int)floorf(originX + dirX * t);
+                normalX = 0, normalY = -stepY;
+            }
+
+            // Rounding at a corner can land the other coordinate back in
+            // this chunk; keep it inside the chunk being entered
+            if (exitX < exitY) {
+                int lo = chunkY * CHUNK_SIZE;
+                if (tileY < lo) tileY = lo;
+                if (tileY > lo + CHUNK_SIZE - 1) tileY = lo + CHUNK_SIZE - 1;
+            } else {
+                int lo = chunkX * CHUNK_SIZE;
+                if (tileX < lo) tileX = lo;
+                if (tileX > lo + CHUNK_SIZE - 1) tileX = lo + CHUNK_SIZE - 1;
+            }
+            continue;
+        }
+
+        // Walk tiles while they stay in this chunk
+        int localX = tileX - chunkX * CHUNK_SIZE;
+        int localY = tileY - chunkY * CHUNK_SIZE;
+        while (t <= maxT) {
+            if (isCellSolid(chunk, localX, localY)) {
+                hit->hit = true;
+                hit->tileX = tileX;
+                hit->tileY = tileY;
+                hit->distance = t * TILE_SIZE;
+                hit->point = (Vector2){ray.origin.x + dirX * hit->distance, ray.origin.y + dirY * hit->distance};
+                hit->normalX = normalX;
+                hit->normalY = normalY;
+                return true;
+            }
+
+            if (tMaxX < tMaxY) {
+                t = tMaxX;
+                tMaxX += deltaX;
+                tileX += stepX;
+                localX += stepX;
+                normalX = -stepX, normalY = 0;
+            } else {
+                t = tMaxY;
+                tMaxY += deltaY;
+                tileY += stepY;
+                localY += stepY;
+                normalX = 0, normalY = -stepY;
+            }
+            if (localX < 0 || localX >= CHUNK_SIZE || localY < 0 || localY >= CHUNK_SIZE) break;
+        }
+    }
+    return false;
+}
+
+bool castTileRay(TileRay ray, TileRayHit* hit) {
+    RayChunkCache cache;
+    memset(cache.valid, 0, sizeof(cache.valid));
+    return castWithCache(&cache, ray, hit);
+}
+
+void castTileRays(const TileRay* rays, TileRayHit* hits, int count) {
+    RayChunkCache cache;
+    memset(cache.valid, 0, sizeof(cache.valid));
+    for (int i = 0; i < count; i++) castWithCache(&cache, rays[i], &hits[i]);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// Line of sight and hit-scan through the tile world. Rays walk the tile
+// grid with a DDA over the occupancy masks and cross a chunk with nothing
+// solid in it (or one that isn't loaded) in a single step, so open caves
+// and sky cost a handful of steps per chunk instead of one per tile.
+// Rays wrap around the world horizontally like everything else.
+
+typedef struct TileRay
+{
+    Vector2 origin;    // World pixels, may be unwrapped
+    Vector2 direction; // Need not be normalized
+    float maxDistance; // Pixels
+} TileRay;
+
+typedef struct TileRayHit
+{
+    bool hit;
+    int tileX, tileY; // Solid tile hit, unwrapped like the origin
+    float distance;   // Pixels from the origin to where the ray entered it
+    Vector2 point;    // That entry point
+    int normalX, normalY; // Face that was hit; zero when the origin is inside rock
+} TileRayHit;
+
+bool castTileRay(TileRay ray, TileRayHit* hit);
+
+// Casts many rays sharing one chunk lookup cache, for callers that cast
+// hundreds per frame (vision cones, light probes)
+void castTileRays(const TileRay* rays, TileRayHit* hits, int count);
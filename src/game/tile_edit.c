@@ -0,0 +1,132 @@
+#include "tile_edit.h"
+#include "occupancy.h"
+#include "liquid.h"
+#include "light.h"
+
+// An edit as one span of columns per row, in world tiles
+typedef struct EditShape
+{
+    int minX, minY, maxX, maxY; // Bounds
+    bool circle;
+    int centerX, centerY;
+    int halfWidth[2 * TILE_EDIT_MAX_RADIUS + 1]; // Circle only, per row from minY
+} EditShape;
+
+static inline int floorDiv(int value, int divisor) {
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static inline void rowSpan(const EditShape* shape, int tileY, int* minX, int* maxX) {
+    if (shape->circle) {
+        int halfWidth = shape->halfWidth[tileY - shape->minY];
+        *minX = shape->centerX - halfWidth;
+        *maxX = shape->centerX + halfWidth;
+    } else {
+        *minX = shape->minX;
+        *maxX = shape->maxX;
+    }
+}
+
+// Writes the shape's part of one chunk. Returns the tiles changed and the
+// local rectangle they span.
+static int editChunk(Chunk* chunk, int chunkX, int chunkY, const EditShape* shape, TileType tile,
+                     int* dirtyMinX, int* dirtyMinY, int* dirtyMaxX, int* dirtyMaxY) {
+    int baseX = chunkX * CHUNK_SIZE;
+    int baseY = chunkY * CHUNK_SIZE;
+    int startY = (shape->minY > baseY) ? shape->minY - baseY : 0;
+    int endY = (shape->maxY < baseY + CHUNK_SIZE - 1) ? shape->maxY - baseY : CHUNK_SIZE - 1;
+
+    int changed = 0;
+    *dirtyMinX = *dirtyMinY = CHUNK_SIZE;
+    *dirtyMaxX = *dirtyMaxY = -1;
+    for (int y = startY; y <= endY; y++) {
+        int spanMinX, spanMaxX;
+        rowSpan(shape, baseY + y, &spanMinX, &spanMaxX);
+        int startX = (spanMinX > baseX) ? spanMinX - baseX : 0;
+        int endX = (spanMaxX < baseX + CHUNK_SIZE - 1) ? spanMaxX - baseX : CHUNK_SIZE - 1;
+
+        int rowChanged = 0;
+        for (int x = startX; x <= endX; x++) {
+            if (chunk->tiles[x][y] == tile) continue;
+            chunk->tiles[x][y] = tile;
+            invalidateLight(chunk, x, y);
+            if (x < *dirtyMinX) *dirtyMinX = x;
+            if (x > *dirtyMaxX) *dirtyMaxX = x;
+            rowChanged++;
+        }
+        if (!rowChanged) continue;
+
+        rebuildSolidRow(chunk, y);
+        if (y < *dirtyMinY) *dirtyMinY = y;
+        *dirtyMaxY = y;
+        changed += rowChanged;
+    }
+    return changed;
+}
+
+// Visits every chunk the shape or its one-tile border reaches. The border
+// matters for liquid: a cell next to the edit may now be able to flow
+// into it. Chunks are walked in unwrapped columns and each visit only
+// takes the tiles inside that column, so a lap that doesn't start on a
+// chunk boundary visits its first chunk twice, once for each end.
+static int applyShape(EditShape* shape, TileType tile) {
+    if (shape->maxX - shape->minX >= WORLD_WIDTH_TILES) shape->maxX = shape->minX + WORLD_WIDTH_TILES - 1;
+
+    int wakeMinX = shape->minX - 1, wakeMaxX = shape->maxX + 1;
+    int wakeMinY = shape->minY - 1, wakeMaxY = shape->maxY + 1;
+    int startChunkX = floorDiv(wakeMinX, CHUNK_SIZE), endChunkX = floorDiv(wakeMaxX, CHUNK_SIZE);
+    int startChunkY = floorDiv(wakeMinY, CHUNK_SIZE), endChunkY = floorDiv(wakeMaxY, CHUNK_SIZE);
+
+    int changed = 0;
+    for (int chunkX = startChunkX; chunkX <= endChunkX; chunkX++) {
+        for (int chunkY = startChunkY; chunkY <= endChunkY; chunkY++) {
+            Chunk* chunk = getChunk(chunkX, chunkY);
+            if (!chunk || !chunk->generated) continue;
+
+            int minX, minY, maxX, maxY;
+            int chunkChanged = editChunk(chunk, chunkX, chunkY, shape, tile, &minX, &minY, &maxX, &maxY);
+            if (chunkChanged) markChunkRegionChanged(chunk, minX, minY, maxX, maxY);
+            changed += chunkChanged;
+
+            int baseX = chunkX * CHUNK_SIZE, baseY = chunkY * CHUNK_SIZE;
+            int wakeStartX = (wakeMinX > baseX) ? wakeMinX - baseX : 0;
+            int wakeStartY = (wakeMinY > baseY) ? wakeMinY - baseY : 0;
+            int wakeEndX = (wakeMaxX < baseX + CHUNK_SIZE - 1) ? wakeMaxX - baseX : CHUNK_SIZE - 1;
+            int wakeEndY = (wakeMaxY < baseY + CHUNK_SIZE - 1) ? wakeMaxY - baseY : CHUNK_SIZE - 1;
+            wakeLiquidRegion(chunk, wakeStartX, wakeStartY, wakeEndX, wakeEndY);
+        }
+    }
+    propagateLight();
+    return changed;
+}
+
+int setTile(int tileX, int tileY, TileType tile) {
+    return fillRect(tileX, tileY, tileX, tileY, tile);
+}
+
+int fillRect(int minTileX, int minTileY, int maxTileX, int maxTileY, TileType tile) {
+    if (maxTileX < minTileX || maxTileY < minTileY) return 0;
+
+    EditShape shape = {.minX = minTileX, .minY = minTileY, .maxX = maxTileX, .maxY = maxTileY};
+    return applyShape(&shape, tile);
+}
+
+int fillCircle(int centerTileX, int centerTileY, int radius, TileType tile) {
+    if (radius < 0) return 0;
+    if (radius > TILE_EDIT_MAX_RADIUS) radius = TILE_EDIT_MAX_RADIUS;
+
+    EditShape shape = {
+        .minX = centerTileX - radius, .minY = centerTileY - radius,
+        .maxX = centerTileX + radius, .maxY = centerTileY + radius,
+        .circle = true, .centerX = centerTileX, .centerY = centerTileY,
+    };
+
+    // Widest dx with dx^2 + dy^2 <= radius^2, narrowing from the middle row out
+    int halfWidth = radius;
+    for (int dy = 0; dy <= radius; dy++) {
+        while (halfWidth * halfWidth + dy * dy > radius * radius) halfWidth--;
+        shape.halfWidth[radius - dy] = halfWidth;
+        shape.halfWidth[radius + dy] = halfWidth;
+    }
+    return applyShape(&shape, tile);
+}
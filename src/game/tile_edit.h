@@ -0,0 +1,29 @@
+#pragma once
+
+#include "chunk.h"
+
+// Changing the world after generation. An edit is walked chunk by chunk,
+// so a blast covering hundreds of tiles visits each chunk it reaches once
+// (a full lap can reach its first chunk from both ends, for two visits):
+// the tiles are written row by row, the solid mask is rebuilt for just the
+// rows that changed, the chunk's version is bumped once with the local
+// rectangle that changed (see ChunkDirty, which lets render caches upload
+// only that part), the changed cells are invalidated for lighting, and the
+// liquid cells in and around the rectangle are woken, since they may now
+// have somewhere to flow. One light pass then relights the whole edit.
+//
+// Coordinates are world tiles. X wraps around the world; Y is unbounded.
+// Tiles in chunks that aren't loaded are left alone, so an edit there is
+// lost, and an edit wider than the world is clipped to one lap.
+
+#define TILE_EDIT_MAX_RADIUS 64
+
+// Each returns how many tiles actually changed
+int setTile(int tileX, int tileY, TileType tile);
+
+// Inclusive rectangle
+int fillRect(int minTileX, int minTileY, int maxTileX, int maxTileY, TileType tile);
+
+// Every tile whose center is within radius tiles of the center tile's,
+// radius clamped to TILE_EDIT_MAX_RADIUS
+int fillCircle(int centerTileX, int centerTileY, int radius, TileType tile);
@@ -0,0 +1,164 @@
+#include "world_gen.h"
+#include "level.h"
+#include <string.h>
+#include <stdio.h>
+
+// Noise lattice cells around the world for each generation layer
+#define SURFACE_NOISE_PERIOD 6
+#define CAVE_NOISE_PERIOD 13
+#define WATER_NOISE_PERIOD 19
+
+// Noise lattice cells per tile row
+#define CAVE_NOISE_Y_SCALE 0.02f
+#define WATER_NOISE_Y_SCALE 0.05f
+
+static WorldGenParams currentParams = {0};
+static uint64_t currentHash = 0;
+static NoiseProgram terrainProgram = {0};
+
+// FNV-1a, fed field by field so struct padding never reaches the hash
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+#define HASH_FIELD(hash, value) hashBytes((hash), &(value), sizeof(value))
+
+static uint32_t mixSeed(uint32_t seed, uint32_t salt) {
+    uint32_t h = seed ^ (salt * 0x9e3779b9u);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+WorldGenParams defaultWorldGenParams(uint32_t seed) {
+    return (WorldGenParams){
+        .seed = seed,
+        .noiseBackend = NOISE_BACKEND_GRADIENT2D,
+        .surfaceLevel = 128,
+        .surfaceAmplitude = 30.0f,
+        .caveThreshold = 0.3f,
+        .waterThreshold = 0.6f,
+        .dirtDepth = 3,
+        .caveStartY = 140,
+        .waterStartY = 200,
+        .biomePeriod = 8,
+        .biomeWarpPeriod = 3,
+        .biomeWarp = 0.04f,
+    };
+}
+
+uint64_t hashWorldGenParams(const WorldGenParams* params) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    int version = WORLD_GEN_VERSION;
+    int backend = (int)params->noiseBackend;
+
+    hash = HASH_FIELD(hash, version);
+    hash = HASH_FIELD(hash, params->seed);
+    hash = HASH_FIELD(hash, backend);
+    hash = HASH_FIELD(hash, params->surfaceLevel);
+    hash = HASH_FIELD(hash, params->surfaceAmplitude);
+    hash = HASH_FIELD(hash, params->caveThreshold);
+    hash = HASH_FIELD(hash, params->waterThreshold);
+    hash = HASH_FIELD(hash, params->dirtDepth);
+    hash = HASH_FIELD(hash, params->caveStartY);
+    hash = HASH_FIELD(hash, params->waterStartY);
+    hash = HASH_FIELD(hash, params->biomePeriod);
+    hash = HASH_FIELD(hash, params->biomeWarpPeriod);
+    hash = HASH_FIELD(hash, params->biomeWarp);
+    return hash;
+}
+
+void setWorldGenParams(const WorldGenParams* params) {
+    uint64_t hash = hashWorldGenParams(params);
+    setNoiseBackend(params->noiseBackend);
+    if (hash == currentHash && terrainProgram.valid) return;
+
+    currentParams = *params;
+    currentHash = hash;
+
+    NoiseGraph graph;
+    buildTerrainGraph(params, &graph);
+    if (!compileNoiseGraph(&graph, &terrainProgram)) {
+        printf("Failed to compile terrain graph\n");
+    }
+}
+
+const WorldGenParams* getWorldGenParams() {
+    return &currentParams;
+}
+
+uint64_t getWorldGenHash() {
+    return currentHash;
+}
+
+uint32_t getWorldGenLayerSeed(WorldGenLayer layer) {
+    return mixSeed(currentParams.seed, (uint32_t)layer + 1);
+}
+
+void buildTerrainGraph(const WorldGenParams* params, NoiseGraph* graph) {
+    initNoiseGraph(graph);
+    NoiseGraph* g = graph;
+
+    uint32_t surfaceSeed = mixSeed(params->seed, WORLD_GEN_LAYER_SURFACE + 1);
+    uint32_t caveSeed = mixSeed(params->seed, WORLD_GEN_LAYER_CAVES + 1);
+    uint32_t waterSeed = mixSeed(params->seed, WORLD_GEN_LAYER_WATER + 1);
+
+    int y = noiseInput(g, NOISE_INPUT_Y);
+    int one = noiseConst(g, 1.0f);
+    int air = noiseConst(g, TILE_AIR);
+
+    // Surface height per column, sampled between lattice rows where
+    // gradient noise has its full range
+    int height = noiseSample(g, noiseConst(g, 0.5f), -1, SURFACE_NOISE_PERIOD, surfaceSeed);
+    height = noiseBinary(g, NOISE_OP_MUL, height, noiseInput(g, NOISE_INPUT_SURFACE_AMPLITUDE));
+    int surfaceY = noiseUnary(g, NOISE_OP_FLOOR, noiseBinary(g, NOISE_OP_ADD, height, noiseInput(g, NOISE_INPUT_SURFACE_LEVEL)));
+
+    // Dirt band under the surface, rock below it
+    int solid = noiseBinary(g, NOISE_OP_GREATER_EQUAL, y, surfaceY);
+    int dirtBottom = noiseBinary(g, NOISE_OP_ADD, surfaceY, noiseConst(g, params->dirtDepth));
+    int isDirt = noiseBinary(g, NOISE_OP_GREATER, dirtBottom, y);
+    int ground = noiseSelect(g, isDirt, noiseConst(g, TILE_DIRT), noiseConst(g, TILE_ROCK));
+    int terrain = noiseSelect(g, solid, ground, air);
+
+    // Caves carve solid ground below caveStartY
+    int caveZone = noiseBinary(g, NOISE_OP_MUL, solid,
+                               noiseBinary(g, NOISE_OP_GREATER, y, noiseConst(g, params->caveStartY)));
+    int caveY = noiseBinary(g, NOISE_OP_MUL, y, noiseConst(g, CAVE_NOISE_Y_SCALE));
+    int caveNoise = noiseSample(g, caveY, caveZone, CAVE_NOISE_PERIOD, caveSeed);
+    int carved = noiseBinary(g, NOISE_OP_MUL, caveZone,
+                             noiseBinary(g, NOISE_OP_GREATER, caveNoise, noiseInput(g, NOISE_INPUT_CAVE_THRESHOLD)));
+    terrain = noiseSelect(g, carved, air, terrain);
+
+    // Liquid pools in open space below waterStartY; lava in hot biomes
+    int open = noiseBinary(g, NOISE_OP_MAX, noiseBinary(g, NOISE_OP_SUB, one, solid), carved);
+    int liquidZone = noiseBinary(g, NOISE_OP_MUL, open,
+                                 noiseBinary(g, NOISE_OP_GREATER, y, noiseConst(g, params->waterStartY)));
+    int liquidY = noiseBinary(g, NOISE_OP_MUL, y, noiseConst(g, WATER_NOISE_Y_SCALE));
+    int liquidNoise = noiseSample(g, liquidY, liquidZone, WATER_NOISE_PERIOD, waterSeed);
+    int liquid = noiseBinary(g, NOISE_OP_MUL, liquidZone,
+                             noiseBinary(g, NOISE_OP_GREATER, liquidNoise, noiseInput(g, NOISE_INPUT_LIQUID_THRESHOLD)));
+    int liquidType = noiseSelect(g, noiseInput(g, NOISE_INPUT_LAVA), noiseConst(g, TILE_LAVA), noiseConst(g, TILE_WATER));
+    noiseSelect(g, liquid, liquidType, terrain);
+}
+
+const NoiseProgram* getTerrainProgram() {
+    return &terrainProgram;
+}
+
+uint64_t getChunkGenerationKey(int chunkX, int chunkY) {
+    uint64_t hash = currentHash;
+    hash = HASH_FIELD(hash, chunkX);
+    hash = HASH_FIELD(hash, chunkY);
+    return hash;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include "noise.h"
+#include "noise_graph.h"
+
+// Bump whenever generation rules change in code, so anything keyed on
+// the params hash (caches, saved regeneration keys) is invalidated
+#define WORLD_GEN_VERSION 4
+
+// Everything chunk generation depends on. A generated chunk is a pure
+// function of (params, chunkX, chunkY).
+typedef struct WorldGenParams
+{
+    uint32_t seed;
+    NoiseBackend noiseBackend;
+
+    // Baselines that biomes offset, see biome.c
+    int surfaceLevel;       // Mean surface height in tiles
+    float surfaceAmplitude; // Surface height variation in tiles
+    float caveThreshold;    // Noise above this becomes a cave
+    float waterThreshold;   // Noise above this becomes water (or lava)
+
+    int dirtDepth;   // Dirt band thickness below the surface
+    int caveStartY;  // Caves only carve below this tile row
+    int waterStartY; // Liquids only fill below this tile row
+
+    int biomePeriod;     // Climate noise cells around the world
+    int biomeWarpPeriod; // Domain warp noise cells around the world, fewer than biomePeriod
+    float biomeWarp;     // Domain warp strength, as a fraction of the world width
+} WorldGenParams;
+
+// Seeds of the individual noise layers, derived from the world seed
+typedef enum WorldGenLayer
+{
+    WORLD_GEN_LAYER_SURFACE,
+    WORLD_GEN_LAYER_CAVES,
+    WORLD_GEN_LAYER_WATER,
+    WORLD_GEN_LAYER_DECORATION,
+    WORLD_GEN_LAYER_CLIMATE,
+} WorldGenLayer;
+
+WorldGenParams defaultWorldGenParams(uint32_t seed);
+
+// Makes params current for generation, selects their noise backend and
+// recompiles the terrain program when they changed
+void setWorldGenParams(const WorldGenParams* params);
+const WorldGenParams* getWorldGenParams();
+
+// Content hash of the current params (including WORLD_GEN_VERSION)
+uint64_t getWorldGenHash();
+uint64_t hashWorldGenParams(const WorldGenParams* params);
+
+uint32_t getWorldGenLayerSeed(WorldGenLayer layer);
+
+// Key identifying a generated chunk's contents: hash of (params, x, y)
+uint64_t getChunkGenerationKey(int chunkX, int chunkY);
+
+// Describes the terrain layers (surface, dirt band, caves, liquids) as a
+// node graph whose output is a TileType per lane. Thresholds come in
+// per column through the biome input channels.
+void buildTerrainGraph(const WorldGenParams* params, NoiseGraph* graph);
+
+// Compiled terrain graph for the current params
+const NoiseProgram* getTerrainProgram();
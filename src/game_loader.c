@@ -1,13 +1,71 @@
 #include "game_loader.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
 
-static tickFuncT gameTick = NULL;
-static initGameStateFuncT initGameState = NULL;
-static time_t lastModTime = 0;
+#ifndef WINDOWS
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#ifdef LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// Reloads are staged off the frame loop: a background thread notices the
+// rebuilt library, copies it, loads the copy and resolves every entry
+// point. Only a fully valid image is handed over, and the frame loop swaps
+// to it at the top of the next loadGameLib call before unloading the old
+// one. A broken build is reported and the old code keeps running.
+// unloadGameLib stops the thread and waits for it before closing anything.
 
 #ifdef WINDOWS
-static HMODULE gameLib = NULL;
+#define LIB_EXTENSION "dll"
 #elif defined MACOS
-static void *handle = NULL;
+#define LIB_EXTENSION "dylib"
+#else
+#define LIB_EXTENSION "so"
+#endif
+
+#define LIB_NAME "libgamelib." LIB_EXTENSION
+#define LIB_DIR "./out"
+#define LIB_PATH LIB_DIR "/" LIB_NAME
+
+// Without change notifications, how often the reload thread checks the
+// library's modification time
+#define RELOAD_POLL_MS 250
+
+typedef struct GameLib
+{
+  void *handle;
+  char path[64]; // The copy this image was loaded from
+  int copyIndex;
+  tickFuncT gameTick;
+  initGameStateFuncT initGameState;
+  simulateFuncT gameSimulate;
+  statsFuncT getGameStats;
+  benchFuncT gameBenchmark;
+} GameLib;
+
+static GameLib current = {0};
+
+// Written by the reload thread while stagedReady is false, read by the
+// frame loop once it is true
+static GameLib staged = {0};
+static atomic_bool stagedReady = false;
+static bool reloadThreadStarted = false;
+
+// Set by unloadGameLib; the thread checks it between waits and returns
+static atomic_bool reloadStopping = false;
+static bool reloadThreadRunning = false; // Started and not yet joined
+#ifdef WINDOWS
+static HANDLE reloadThreadHandle;
+#else
+static pthread_t reloadThreadHandle;
+#endif
+#ifdef LINUX
+static int stopPipe[2] = {-1, -1}; // A byte here wakes the thread out of poll()
 #endif
 
 time_t getFileModTime(const char *path)
@@ -24,7 +82,7 @@ time_t getFileModTime(const char *path)
   ull.HighPart = fileInfo.ftLastWriteTime.dwHighDateTime;
 
   return (time_t)((ull.QuadPart / 10000000ULL) - 11644473600ULL);
-#elif defined MACOS
+#else
   struct stat attr;
   if (stat(path, &attr) == 0)
     return attr.st_mtime;
@@ -32,113 +90,349 @@ time_t getFileModTime(const char *path)
 #endif
 }
 
-void loadGameLib()
+static void sleepMs(int ms)
 {
 #ifdef WINDOWS
-  static const char *dllPath = "./out/libgamelib.dll";
-  static const char *dllCopyPath = "./out/libgamelib-copy.dll";
-#elif defined MACOS
-  static const char *dllPath = "./out/libgamelib.dylib";
+  Sleep(ms);
+#else
+  usleep(ms * 1000);
+#endif
+}
+
+static void *openLib(const char *path)
+{
+#ifdef WINDOWS
+  return (void *)LoadLibrary(path);
+#else
+  void *handle = dlopen(path, RTLD_NOW);
+  if (!handle)
+    fprintf(stderr, "dlopen error: %s\n", dlerror());
+  return handle;
 #endif
-  time_t currentModTime = getFileModTime(dllPath);
+}
 
-  if (currentModTime <= 0)
+static void *findSymbol(void *handle, const char *name)
+{
+#ifdef WINDOWS
+  return (void *)GetProcAddress((HMODULE)handle, name);
+#else
+  return dlsym(handle, name);
+#endif
+}
+
+static void closeLib(void *handle)
+{
+#ifdef WINDOWS
+  FreeLibrary((HMODULE)handle);
+#else
+  dlclose(handle);
+#endif
+}
+
+static bool copyFile(const char *from, const char *to)
+{
+#ifdef WINDOWS
+  return CopyFile(from, to, FALSE) != 0;
+#else
+  FILE *source = fopen(from, "rb");
+  if (!source)
+    return false;
+  FILE *dest = fopen(to, "wb");
+  if (!dest)
   {
-    printf("Failed to find game dll");
-    exit(1);
-    return;
+    fclose(source);
+    return false;
   }
 
-  if (currentModTime != lastModTime)
+  char buffer[65536];
+  size_t count;
+  bool ok = true;
+  while ((count = fread(buffer, 1, sizeof(buffer), source)) > 0)
   {
-#ifdef WINDOWS
-    if (gameLib)
+    if (fwrite(buffer, 1, count, dest) != count)
     {
-      FreeLibrary(gameLib);
-      gameLib = NULL;
-      gameTick = NULL;
+      ok = false;
+      break;
     }
+  }
+
+  fclose(source);
+  ok = (fclose(dest) == 0) && ok;
+  return ok;
+#endif
+}
+
+// Loads a private copy of the library into lib, which must be empty.
+// dlopen caches by path and Windows locks loaded DLLs, so each image gets
+// its own copy and the build can overwrite the original at any time.
+static bool stageLib(GameLib *lib, int copyIndex)
+{
+  snprintf(lib->path, sizeof(lib->path), LIB_DIR "/libgamelib-live%d." LIB_EXTENSION, copyIndex);
+  lib->copyIndex = copyIndex;
 
-    Sleep(100);
+  if (!copyFile(LIB_PATH, lib->path))
+  {
+    fprintf(stderr, "Failed to copy %s\n", LIB_PATH);
+    return false;
+  }
+
+  lib->handle = openLib(lib->path);
+  if (!lib->handle)
+  {
+    remove(lib->path);
+    return false;
+  }
+
+  lib->gameTick = (tickFuncT)findSymbol(lib->handle, "gameTick");
+  lib->initGameState = (initGameStateFuncT)findSymbol(lib->handle, "initGameState");
+  lib->gameSimulate = (simulateFuncT)findSymbol(lib->handle, "gameSimulate");
+  lib->getGameStats = (statsFuncT)findSymbol(lib->handle, "getGameStats");
+  lib->gameBenchmark = (benchFuncT)findSymbol(lib->handle, "gameBenchmark");
+
+  if (!lib->gameTick || !lib->initGameState || !lib->gameSimulate || !lib->getGameStats || !lib->gameBenchmark)
+  {
+    fprintf(stderr, "%s is missing entry points, keeping the current build\n", LIB_PATH);
+    closeLib(lib->handle);
+    remove(lib->path);
+    *lib = (GameLib){0};
+    return false;
+  }
+  return true;
+}
 
-    CopyFile(dllPath, dllCopyPath, FALSE);
+// Runs on the reload thread. Waits until the previous hand-over finished,
+// so the copy the frame loop still has loaded is never overwritten.
+static void stageReload()
+{
+  while (atomic_load(&stagedReady))
+  {
+    if (atomic_load(&reloadStopping))
+      return;
+    sleepMs(10);
+  }
 
-    Sleep(100);
+  if (stageLib(&staged, 1 - current.copyIndex))
+    atomic_store(&stagedReady, true);
+}
 
-    gameLib = LoadLibrary(dllCopyPath);
+#ifdef LINUX
+// inotify on the output directory: the thread sleeps in read() until the
+// linker closes the rewritten library, so it never sees a partial file
+static void *reloadThread(void *arg)
+{
+  int watchFd = inotify_init1(IN_CLOEXEC);
+  if (watchFd < 0 || inotify_add_watch(watchFd, LIB_DIR, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+  {
+    fprintf(stderr, "inotify unavailable, hot reload disabled\n");
+    if (watchFd >= 0)
+      close(watchFd);
+    return NULL;
+  }
 
-    if (!gameLib)
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct pollfd fds[2] = {{.fd = watchFd, .events = POLLIN}, {.fd = stopPipe[0], .events = POLLIN}};
+  while (!atomic_load(&reloadStopping))
+  {
+    if (poll(fds, 2, -1) < 0)
     {
-      printf("Failed to load DLL\n");
-      exit(1);
+      if (errno == EINTR)
+        continue;
+      break;
     }
+    if (fds[1].revents)
+      break;
 
-    gameTick = (tickFuncT)GetProcAddress(gameLib, "gameTick");
-    initGameState = (initGameStateFuncT)GetProcAddress(gameLib, "initGameState");
+    ssize_t length = read(watchFd, buffer, sizeof(buffer));
+    if (length < 0 && errno == EINTR)
+      continue;
+    if (length <= 0)
+      break;
 
-    lastModTime = currentModTime;
-    printf("Reloaded DLL at %lld\n", lastModTime);
-#elif defined MACOS
-    if (handle)
+    bool changed = false;
+    for (char *cursor = buffer; cursor < buffer + length;)
     {
-      dlclose(handle);
-      handle = NULL;
-      gameTick = NULL;
-      initGameState = NULL;
+      struct inotify_event *event = (struct inotify_event *)cursor;
+      if (event->len && strcmp(event->name, LIB_NAME) == 0)
+        changed = true;
+      cursor += sizeof(struct inotify_event) + event->len;
     }
 
-    handle = dlopen(dllPath, RTLD_LAZY);
-    if (!handle)
+    if (changed)
+      stageReload();
+  }
+  close(watchFd);
+  return NULL;
+}
+#else
+// Polls the modification time, and only reloads once it has held still
+// for a full interval, so a library the linker is still writing is skipped
+#ifdef WINDOWS
+static DWORD WINAPI reloadThread(LPVOID arg)
+#else
+static void *reloadThread(void *arg)
+#endif
+{
+  time_t loadedModTime = getFileModTime(LIB_PATH);
+  time_t pendingModTime = loadedModTime;
+
+  while (!atomic_load(&reloadStopping))
+  {
+    sleepMs(RELOAD_POLL_MS);
+
+    time_t modTime = getFileModTime(LIB_PATH);
+    if (modTime <= 0 || modTime == loadedModTime)
+      continue;
+
+    if (modTime != pendingModTime)
     {
-      fprintf(stderr, "dlopen error: %s\n", dlerror());
-      exit(1);
+      pendingModTime = modTime;
+      continue;
     }
-    else
+
+    stageReload();
+    loadedModTime = modTime;
+  }
+  return 0;
+}
+#endif
+
+static void startReloadThread()
+{
+  reloadThreadStarted = true;
+
+  atomic_store(&reloadStopping, false);
+
+#ifdef WINDOWS
+  reloadThreadHandle = CreateThread(NULL, 0, reloadThread, NULL, 0, NULL);
+  if (!reloadThreadHandle)
+  {
+    fprintf(stderr, "Failed to start the reload thread, hot reload disabled\n");
+    return;
+  }
+#else
+#ifdef LINUX
+  if (pipe(stopPipe) != 0)
+  {
+    fprintf(stderr, "Failed to start the reload thread, hot reload disabled\n");
+    return;
+  }
+#endif
+  if (pthread_create(&reloadThreadHandle, NULL, reloadThread, NULL) != 0)
+  {
+    fprintf(stderr, "Failed to start the reload thread, hot reload disabled\n");
+#ifdef LINUX
+    close(stopPipe[0]);
+    close(stopPipe[1]);
+#endif
+    return;
+  }
+#endif
+  reloadThreadRunning = true;
+}
+
+// Wakes the reload thread and waits for it to return, so it is not
+// halfway through loading a copy when the images are closed. A stage it
+// finished on the way out is left in staged for the caller to claim.
+static void stopReloadThread()
+{
+  if (!reloadThreadRunning)
+    return;
+
+  atomic_store(&reloadStopping, true);
+#ifdef WINDOWS
+  WaitForSingleObject(reloadThreadHandle, INFINITE);
+  CloseHandle(reloadThreadHandle);
+#else
+#ifdef LINUX
+  char wake = 0;
+  if (write(stopPipe[1], &wake, 1) != 1)
+    fprintf(stderr, "Failed to wake the reload thread\n");
+#endif
+  pthread_join(reloadThreadHandle, NULL);
+#ifdef LINUX
+  close(stopPipe[0]);
+  close(stopPipe[1]);
+#endif
+#endif
+  reloadThreadRunning = false;
+  reloadThreadStarted = false;
+}
+
+void loadGameLib()
+{
+  // First call: nothing to keep running, so load synchronously
+  if (!current.handle)
+  {
+    if (getFileModTime(LIB_PATH) <= 0)
     {
-      gameTick = (tickFuncT)dlsym(handle, "gameTick");
-      initGameState = (initGameStateFuncT)dlsym(handle, "initGameState");
-      char *error = dlerror();
-      if (error != NULL)
-      {
-        fprintf(stderr, "dlsym error: %s\n", error);
-        dlclose(handle);
-        handle = NULL;
-        gameTick = NULL;
-        initGameState = NULL;
-      }
-      else
-      {
-        lastModTime = currentModTime;
-        printf("Reloaded DLL at %ld\n", lastModTime);
-      }
+      printf("Failed to find game library %s\n", LIB_PATH);
+      exit(1);
     }
-#endif
+    if (!stageLib(&current, 0))
+      exit(1);
+
+    printf("Loaded %s\n", LIB_PATH);
+    if (!reloadThreadStarted)
+      startReloadThread();
+    return;
   }
+
+  // Frame boundary: swap to a staged image, then drop the old one
+  if (!atomic_load(&stagedReady))
+    return;
+
+  GameLib old = current;
+  current = staged;
+  staged = (GameLib){0};
+
+  closeLib(old.handle);
+  remove(old.path);
+
+  atomic_store(&stagedReady, false);
+  printf("Reloaded %s\n", LIB_PATH);
 }
 
 void unloadGameLib()
 {
-#ifdef WINDOWS
-  if (gameLib)
+  // Once the thread is gone, staged holds a finished image or nothing
+  stopReloadThread();
+  if (atomic_load(&stagedReady))
   {
-    FreeLibrary(gameLib);
-    gameLib = NULL;
-    gameTick = NULL;
+    closeLib(staged.handle);
+    remove(staged.path);
+    staged = (GameLib){0};
   }
-#elif defined MACOS
-  dlclose(handle);
-  handle = NULL;
-  gameTick = NULL;
-  initGameState = NULL;
-#endif
+
+  if (current.handle)
+  {
+    closeLib(current.handle);
+    remove(current.path);
+  }
+  current = (GameLib){0};
+  atomic_store(&stagedReady, false);
 }
 
 tickFuncT getGameTickFunc()
 {
-  return gameTick;
+  return current.gameTick;
 }
 
 initGameStateFuncT getInitGameStateFunc()
 {
-  return initGameState;
+  return current.initGameState;
+}
+
+simulateFuncT getSimulateFunc()
+{
+  return current.gameSimulate;
+}
+
+statsFuncT getStatsFunc()
+{
+  return current.getGameStats;
+}
+
+benchFuncT getBenchFunc()
+{
+  return current.gameBenchmark;
 }
@@ -7,6 +7,10 @@
 #include <dlfcn.h>
 #include <sys/stat.h>
 #endif
+#elif defined __linux__
+#define LINUX
+#include <dlfcn.h>
+#include <sys/stat.h>
 #elif defined _WIN32
 #define WINDOWS
 
@@ -93,9 +97,9 @@ typedef struct tagBITMAPINFOHEADER
 #include "stdio.h"
 #include "time.h"
 #include "stdlib.h"
+#include "game/game_api.h"
 
 typedef void (*tickFuncT)(void *gameState);
-typedef void *(*initGameStateFuncT)(void);
 
 void loadGameLib();
 
@@ -104,3 +108,10 @@ void unloadGameLib();
 tickFuncT getGameTickFunc();
 
 initGameStateFuncT getInitGameStateFunc();
+
+// Window-free entry points, used by the headless host
+simulateFuncT getSimulateFunc();
+
+statsFuncT getStatsFunc();
+
+benchFuncT getBenchFunc();
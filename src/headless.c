@@ -0,0 +1,200 @@
+#include <string.h>
+#include "game_loader.h"
+#include "work_queue.h"
+#include "globals.h"
+
+#ifndef WINDOWS
+#include <sys/resource.h>
+#endif
+
+// Drives the game library without a window: scripted input for a fixed
+// number of sim ticks, then throughput, chunk counts and memory.
+// Build with `make headless`, run ./out/headless [ticks] [script]
+//
+// ./out/headless --bench <name> instead runs one of the library's built-in
+// benchmarks or checks (see src/game/bench.c) on a fresh world. Set
+// WORLD_SEED to compare runs on the same terrain.
+//
+// A script is comma-separated steps of a direction (L, R, U, D or S to
+// stand still) and a tick count, e.g. "R600,D300". It loops until done.
+
+#define DEFAULT_TICKS 3600
+#define DEFAULT_SCRIPT "R600,D300,R600,U300"
+#define MAX_SCRIPT_STEPS 64
+
+typedef struct ScriptStep
+{
+  float moveX, moveY;
+  int ticks;
+} ScriptStep;
+
+static int parseScript(const char *script, ScriptStep *steps)
+{
+  int count = 0;
+  const char *cursor = script;
+  while (*cursor && count < MAX_SCRIPT_STEPS)
+  {
+    ScriptStep step = {0};
+    switch (*cursor)
+    {
+    case 'L': step.moveX = -1.0f; break;
+    case 'R': step.moveX = 1.0f; break;
+    case 'U': step.moveY = -1.0f; break;
+    case 'D': step.moveY = 1.0f; break;
+    case 'S': break;
+    default:
+      printf("Bad script step at '%s'\n", cursor);
+      return 0;
+    }
+
+    step.ticks = (int)strtol(cursor + 1, (char **)&cursor, 10);
+    if (step.ticks <= 0)
+    {
+      printf("Script steps need a positive tick count\n");
+      return 0;
+    }
+    steps[count++] = step;
+
+    if (*cursor == ',') cursor++;
+  }
+  return count;
+}
+
+static double wallSeconds()
+{
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  return (double)now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Peak resident set size in bytes, 0 where unsupported
+static unsigned long long peakMemory()
+{
+#ifdef WINDOWS
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef MACOS
+  return (unsigned long long)usage.ru_maxrss; // Bytes on macOS
+#else
+  return (unsigned long long)usage.ru_maxrss * 1024; // Kilobytes elsewhere
+#endif
+#endif
+}
+
+static int runBenchmark(void *gameState, const char *name)
+{
+  BenchReport report;
+  if (!getBenchFunc()(gameState, name, &report))
+  {
+    printf("%s: FAILED\n%s\n", name, report.detail);
+    return 1;
+  }
+
+  if (report.seconds > 0)
+  {
+    printf("%s: %llu %s in %.3f s (%.0f %s/s)\n", name, (unsigned long long)report.operations, report.unit,
+           report.seconds, report.operations / report.seconds, report.unit);
+  }
+  else
+  {
+    printf("%s: %llu %s\n", name, (unsigned long long)report.operations, report.unit);
+  }
+  printf("%s\n", report.detail);
+  printf("Peak RSS: %.1f MiB\n", peakMemory() / (1024.0 * 1024.0));
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *benchName = NULL;
+  if (argc > 2 && strcmp(argv[1], "--bench") == 0)
+  {
+    benchName = argv[2];
+    argc = 1;
+  }
+
+  int ticks = (argc > 1) ? atoi(argv[1]) : DEFAULT_TICKS;
+  const char *script = (argc > 2) ? argv[2] : DEFAULT_SCRIPT;
+
+  ScriptStep steps[MAX_SCRIPT_STEPS];
+  int stepCount = parseScript(script, steps);
+  if (ticks <= 0 || stepCount == 0)
+  {
+    printf("Usage: headless [ticks] [script] | headless --bench <name>\n");
+    return 1;
+  }
+
+  loadGameLib();
+
+  initGameStateFuncT initGameState = getInitGameStateFunc();
+  simulateFuncT gameSimulate = getSimulateFunc();
+  statsFuncT getGameStats = getStatsFunc();
+
+  if (!initGameState || !gameSimulate || !getGameStats || !getBenchFunc())
+  {
+    printf("Failed to load the game's headless entry points\n");
+    return 1;
+  }
+
+  // The host owns all persistent game memory, so it survives reloads
+  void *gameMemory = calloc(1, GAME_MEMORY_SIZE);
+  startWorkQueue(0);
+  GamePlatform platform = getWorkQueuePlatform();
+  void *gameState = gameMemory ? initGameState(gameMemory, GAME_MEMORY_SIZE, &platform) : NULL;
+
+  if (!gameState)
+  {
+    printf("Failed to initialize game state\n");
+    return 1;
+  }
+
+  if (benchName)
+  {
+    int result = runBenchmark(gameState, benchName);
+    unloadGameLib();
+    stopWorkQueue();
+    free(gameMemory);
+    return result;
+  }
+
+  GameInput input = {.viewWidth = SCREEN_WIDTH, .viewHeight = SCREEN_HEIGHT};
+  int step = 0;
+  int stepTicks = 0;
+
+  double start = wallSeconds();
+  for (int tick = 0; tick < ticks; tick++)
+  {
+    input.moveX = steps[step].moveX;
+    input.moveY = steps[step].moveY;
+    gameSimulate(gameState, &input);
+
+    if (++stepTicks >= steps[step].ticks)
+    {
+      step = (step + 1) % stepCount;
+      stepTicks = 0;
+    }
+  }
+  double elapsed = wallSeconds() - start;
+
+  GameStats stats;
+  getGameStats(gameState, &stats);
+
+  printf("Ticks:            %llu in %.3f s (%.0f ticks/s)\n",
+         (unsigned long long)stats.simTicks, elapsed, ticks / elapsed);
+  printf("Chunks generated: %llu (created %llu, unloaded %llu, resident %d)\n",
+         (unsigned long long)stats.chunksGenerated, (unsigned long long)stats.chunksCreated,
+         (unsigned long long)stats.chunksUnloaded, stats.chunksResident);
+  printf("Chunk memory:     %.1f KiB resident\n", stats.chunkBytes / 1024.0);
+  printf("Liquids:          %llu cell updates, %llu moves, %llu reactions\n",
+         (unsigned long long)stats.liquidCellsUpdated, (unsigned long long)stats.liquidMoves,
+         (unsigned long long)stats.liquidReactions);
+  printf("Peak RSS:         %.1f MiB\n", peakMemory() / (1024.0 * 1024.0));
+
+  unloadGameLib();
+  stopWorkQueue();
+  free(gameMemory);
+
+  return 0;
+}
@@ -1,5 +1,6 @@
 #include <raylib.h>
 #include "game_loader.h"
+#include "work_queue.h"
 #include "globals.h"
 
 int main()
@@ -18,7 +19,17 @@ int main()
     return 1;
   }
 
-  void *gameState = initGameState();
+  // The host owns all persistent game memory, so it survives reloads
+  void *gameMemory = calloc(1, GAME_MEMORY_SIZE);
+  startWorkQueue(0);
+  GamePlatform platform = getWorkQueuePlatform();
+  void *gameState = gameMemory ? initGameState(gameMemory, GAME_MEMORY_SIZE, &platform) : NULL;
+
+  if (!gameState) {
+    printf("Failed to initialize game state\n");
+    CloseWindow();
+    return 1;
+  }
 
   while (!WindowShouldClose())
   {
@@ -33,6 +44,8 @@ int main()
   }
 
   unloadGameLib();
+  stopWorkQueue();
+  free(gameMemory);
 
   CloseWindow();
 
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <time.h>
+#include "../game/noise.h"
+
+// Reports samples/sec for every noise backend, scalar and batched.
+// Build with `make bench_noise`, run ./out/noise_bench
+
+#define SAMPLE_COUNT 4096
+#define ROUNDS 512
+
+static float us[SAMPLE_COUNT];
+static float ys[SAMPLE_COUNT];
+static float out[SAMPLE_COUNT];
+
+static double secondsSince(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+  // One chunk-column-like pattern repeated: u sweeps the world, y walks down
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+  {
+    us[i] = (float)(i % 1024) / 1024.0f;
+    ys[i] = (float)(i / 1024) * 0.37f + (float)(i % 16) * 0.02f;
+  }
+
+  const long total = (long)SAMPLE_COUNT * ROUNDS;
+
+  for (int backend = 0; backend < NOISE_BACKEND_COUNT; backend++)
+  {
+    setNoiseBackend((NoiseBackend)backend);
+
+    float sink = 0;
+    clock_t start = clock();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+      for (int i = 0; i < SAMPLE_COUNT; i++)
+      {
+        sink += sampleWrappedNoise(us[i], ys[i] + round, 13, 0);
+      }
+    }
+    double scalarTime = secondsSince(start);
+
+    start = clock();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+      ys[round % SAMPLE_COUNT] += 1.0f;
+      sampleWrappedNoiseBatch(us, ys, out, SAMPLE_COUNT, 13, 0);
+      sink += out[round % SAMPLE_COUNT];
+    }
+    double batchTime = secondsSince(start);
+
+    printf("%-12s scalar: %8.2f Msamples/s  batch: %8.2f Msamples/s  (checksum %.3f)\n",
+           getNoiseBackendName((NoiseBackend)backend),
+           total / scalarTime / 1e6, total / batchTime / 1e6, sink);
+  }
+
+  return 0;
+}
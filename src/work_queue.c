@@ -0,0 +1,226 @@
+#include "work_queue.h"
+#include "game_loader.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#ifndef WINDOWS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// One batch at a time: parallelFor publishes the job under the lock,
+// every thread (the caller included) claims indices from a shared counter,
+// and the caller returns once every index has run and every worker that
+// joined the batch has left it. A worker only joins, under the lock, while
+// the batch still has unclaimed indices; one that wakes late, after the
+// batch ran out, goes back to waiting instead. So no worker can still be
+// holding a batch's job and context once parallelFor has returned, and a
+// late claim can never take indices from the next batch.
+
+#define MAX_WORKER_THREADS 64
+
+#ifdef WINDOWS
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+#define lockMutex(m) EnterCriticalSection(m)
+#define unlockMutex(m) LeaveCriticalSection(m)
+#define waitCondition(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define wakeAll(c) WakeAllConditionVariable(c)
+#else
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+#define lockMutex(m) pthread_mutex_lock(m)
+#define unlockMutex(m) pthread_mutex_unlock(m)
+#define waitCondition(c, m) pthread_cond_wait(c, m)
+#define wakeAll(c) pthread_cond_broadcast(c)
+#endif
+
+typedef struct WorkQueue
+{
+  Mutex lock;
+  Condition batchPosted;   // Workers wait here for a new batch
+  Condition batchFinished; // The caller waits here for the stragglers
+
+  // The current batch, written under the lock
+  uint64_t batch;
+  GameJobFuncT job;
+  void *context;
+  int count;
+  atomic_int nextIndex;
+  atomic_int finished;
+  int joinedWorkers; // Workers that joined the current batch
+  int leftWorkers;   // Of those, the ones done with it
+
+  int threadCount;
+  bool stopping;
+} WorkQueue;
+
+static WorkQueue queue = {0};
+static bool queueStarted = false;
+
+// Claims and runs indices until the batch is exhausted. Returns how many
+// this thread ran.
+static int runIndices(GameJobFuncT job, void *context, int count)
+{
+  int ran = 0;
+  for (;;)
+  {
+    int index = atomic_fetch_add(&queue.nextIndex, 1);
+    if (index >= count)
+      break;
+    job(context, index);
+    ran++;
+  }
+  return ran;
+}
+
+#ifdef WINDOWS
+static DWORD WINAPI workerThread(LPVOID arg)
+#else
+static void *workerThread(void *arg)
+#endif
+{
+  uint64_t seenBatch = 0;
+
+  lockMutex(&queue.lock);
+  for (;;)
+  {
+    while (!queue.stopping && queue.batch == seenBatch)
+      waitCondition(&queue.batchPosted, &queue.lock);
+    if (queue.stopping)
+      break;
+
+    seenBatch = queue.batch;
+    GameJobFuncT job = queue.job;
+    void *context = queue.context;
+    int count = queue.count;
+
+    // The caller can't have returned while indices are unclaimed, and it
+    // rechecks under this lock, so joining now holds it until we leave
+    if (atomic_load(&queue.nextIndex) >= count)
+      continue;
+    queue.joinedWorkers++;
+    unlockMutex(&queue.lock);
+
+    int ran = runIndices(job, context, count);
+
+    lockMutex(&queue.lock);
+    queue.leftWorkers++;
+    atomic_fetch_add(&queue.finished, ran);
+    wakeAll(&queue.batchFinished);
+  }
+  unlockMutex(&queue.lock);
+  return 0;
+}
+
+static void parallelFor(int count, GameJobFuncT job, void *context)
+{
+  if (count <= 0)
+    return;
+
+  // Not worth waking anyone for
+  if (queue.threadCount <= 1 || count == 1)
+  {
+    for (int i = 0; i < count; i++)
+      job(context, i);
+    return;
+  }
+
+  lockMutex(&queue.lock);
+  queue.job = job;
+  queue.context = context;
+  queue.count = count;
+  atomic_store(&queue.nextIndex, 0);
+  atomic_store(&queue.finished, 0);
+  queue.joinedWorkers = 0;
+  queue.leftWorkers = 0;
+  queue.batch++;
+  wakeAll(&queue.batchPosted);
+  unlockMutex(&queue.lock);
+
+  int ran = runIndices(job, context, count);
+
+  lockMutex(&queue.lock);
+  atomic_fetch_add(&queue.finished, ran);
+  while (atomic_load(&queue.finished) < count || queue.leftWorkers < queue.joinedWorkers)
+    waitCondition(&queue.batchFinished, &queue.lock);
+  unlockMutex(&queue.lock);
+}
+
+static int defaultThreadCount()
+{
+  const char *threadsEnv = getenv("SIM_THREADS");
+  if (threadsEnv && *threadsEnv)
+    return atoi(threadsEnv);
+
+#ifdef WINDOWS
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+#else
+  return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+void startWorkQueue(int threadCount)
+{
+  if (queueStarted)
+    return;
+
+  if (threadCount <= 0)
+    threadCount = defaultThreadCount();
+  if (threadCount < 1)
+    threadCount = 1;
+  if (threadCount > MAX_WORKER_THREADS)
+    threadCount = MAX_WORKER_THREADS;
+
+#ifdef WINDOWS
+  InitializeCriticalSection(&queue.lock);
+  InitializeConditionVariable(&queue.batchPosted);
+  InitializeConditionVariable(&queue.batchFinished);
+#else
+  pthread_mutex_init(&queue.lock, NULL);
+  pthread_cond_init(&queue.batchPosted, NULL);
+  pthread_cond_init(&queue.batchFinished, NULL);
+#endif
+  queueStarted = true;
+
+  // The caller counts as a thread; a worker that fails to start just
+  // leaves the pool smaller
+  queue.threadCount = 1;
+  for (int i = 1; i < threadCount; i++)
+  {
+#ifdef WINDOWS
+    HANDLE thread = CreateThread(NULL, 0, workerThread, NULL, 0, NULL);
+    if (!thread)
+      break;
+    CloseHandle(thread);
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, workerThread, NULL) != 0)
+      break;
+    pthread_detach(thread);
+#endif
+    queue.threadCount++;
+  }
+}
+
+// Workers are detached; they see the flag and exit on their own
+void stopWorkQueue()
+{
+  if (!queueStarted)
+    return;
+
+  lockMutex(&queue.lock);
+  queue.stopping = true;
+  wakeAll(&queue.batchPosted);
+  unlockMutex(&queue.lock);
+}
+
+GamePlatform getWorkQueuePlatform()
+{
+  return (GamePlatform){
+      .workerCount = queueStarted ? queue.threadCount : 1,
+      .parallelFor = parallelFor,
+  };
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "game/game_api.h"
+
+// A fixed pool of worker threads the host lends to the game library
+// through GamePlatform. The threads live in the host, and no worker
+// touches a batch's job or context once parallelFor has returned for it
+// (a worker that wakes after the batch ran out doesn't join it), so they
+// never run library code outside a parallelFor call and a reload can't
+// pull code out from under them.
+
+// Starts threadCount - 1 workers; the calling thread is the last one.
+// threadCount <= 0 picks SIM_THREADS from the environment, or one per CPU.
+void startWorkQueue(int threadCount);
+
+void stopWorkQueue();
+
+// What the host passes to initGameState
+GamePlatform getWorkQueuePlatform();